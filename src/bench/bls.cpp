@@ -5,6 +5,7 @@
 
 #include "bench.h"
 #include "random.h"
+#include "bls/bls_batchverifier.h"
 #include "bls/bls_worker.h"
 #include "utiltime.h"
 
@@ -349,6 +350,67 @@ static void BLSVerify_BatchedParallel(benchmark::State& state)
     }
 }
 
+static void BLSVerify_BatchVerifier(size_t invalidCount, bool parallel, benchmark::State& state)
+{
+    BLSPublicKeyVector pubKeys;
+    BLSSecretKeyVector secKeys;
+    BLSSignatureVector sigs;
+    std::vector<uint256> msgHashes;
+    std::vector<bool> invalid;
+    BuildTestVectors(1000, invalidCount, pubKeys, secKeys, sigs, msgHashes, invalid);
+
+    // Benchmark.
+    while (state.KeepRunning()) {
+        CBLSBatchVerifier<size_t, size_t> batchVerifier(false, true, 0, parallel ? &blsWorker : nullptr);
+        for (size_t i = 0; i < pubKeys.size(); i++) {
+            // 10 messages per source
+            batchVerifier.PushMessage(i / 10, i, msgHashes[i], sigs[i], pubKeys[i]);
+        }
+        batchVerifier.Verify();
+
+        for (size_t i = 0; i < pubKeys.size(); i++) {
+            bool valid = !batchVerifier.badMessages.count(i);
+            if (valid && invalid[i]) {
+                std::cout << "expected invalid but it is valid" << std::endl;
+                assert(false);
+            } else if (!valid && !invalid[i]) {
+                std::cout << "expected valid but it is invalid" << std::endl;
+                assert(false);
+            }
+        }
+    }
+}
+
+static void BLSVerify_BatchVerifier0Bad(benchmark::State& state)
+{
+    BLSVerify_BatchVerifier(0, false, state);
+}
+
+static void BLSVerify_BatchVerifier1Bad(benchmark::State& state)
+{
+    BLSVerify_BatchVerifier(10, false, state);
+}
+
+static void BLSVerify_BatchVerifier10Bad(benchmark::State& state)
+{
+    BLSVerify_BatchVerifier(100, false, state);
+}
+
+static void BLSVerify_BatchVerifierParallel0Bad(benchmark::State& state)
+{
+    BLSVerify_BatchVerifier(0, true, state);
+}
+
+static void BLSVerify_BatchVerifierParallel1Bad(benchmark::State& state)
+{
+    BLSVerify_BatchVerifier(10, true, state);
+}
+
+static void BLSVerify_BatchVerifierParallel10Bad(benchmark::State& state)
+{
+    BLSVerify_BatchVerifier(100, true, state);
+}
+
 BENCHMARK(BLSPubKeyAggregate_Normal)
 BENCHMARK(BLSSecKeyAggregate_Normal)
 BENCHMARK(BLSSign_Normal)
@@ -361,3 +423,9 @@ BENCHMARK(BLSVerify_LargeAggregatedBlock10000)
 BENCHMARK(BLSVerify_LargeAggregatedBlock1000PreVerified)
 BENCHMARK(BLSVerify_Batched)
 BENCHMARK(BLSVerify_BatchedParallel)
+BENCHMARK(BLSVerify_BatchVerifier0Bad)
+BENCHMARK(BLSVerify_BatchVerifier1Bad)
+BENCHMARK(BLSVerify_BatchVerifier10Bad)
+BENCHMARK(BLSVerify_BatchVerifierParallel0Bad)
+BENCHMARK(BLSVerify_BatchVerifierParallel1Bad)
+BENCHMARK(BLSVerify_BatchVerifierParallel10Bad)
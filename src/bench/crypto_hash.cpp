@@ -15,6 +15,10 @@
 #include "crypto/sha1.h"
 #include "crypto/sha256.h"
 #include "crypto/sha512.h"
+#include "crypto/x11.h"
+#include "primitives/block.h"
+#include "streams.h"
+#include "versionbits.h"
 
 /* Number of bytes to hash per iteration */
 static const uint64_t BUFFER_SIZE = 1000*1000;
@@ -217,6 +221,49 @@ static void HASH_X11_2048b_single(benchmark::State& state)
         hash = HashX11(in.begin(), in.end());
 }
 
+/* Number of nonces to scan per iteration in the X11 mining benchmarks,
+ * hashes per second are NONCE_SCAN_SIZE divided by the time per iteration */
+static const uint32_t NONCE_SCAN_SIZE = 1024;
+
+static CBlockHeader MiningHeader()
+{
+    CBlockHeader header;
+    header.nVersion = BlockTypeBits::BLOCKTYPE_MINING | VERSIONBITS_TOP_BITS;
+    header.hashPrevBlock = uint256S("0x01");
+    header.hashMerkleRoot = uint256S("0x02");
+    header.nTime = 1577836800;
+    header.nBits = 0x1e0ffff0;
+    return header;
+}
+
+static void HASH_X11_NonceScan_GetHash(benchmark::State& state)
+{
+    CBlockHeader header = MiningHeader();
+    uint256 hash;
+    while (state.KeepRunning()) {
+        for (uint32_t i = 0; i < NONCE_SCAN_SIZE; i++) {
+            header.nNonce++;
+            hash = header.GetHash();
+        }
+    }
+}
+
+static void HASH_X11_NonceScan_Batch(benchmark::State& state)
+{
+    std::vector<unsigned char> vch;
+    CVectorWriter ss(SER_NETWORK, PROTOCOL_VERSION, vch, 0);
+    ss << MiningHeader();
+    CX11NonceHasher hasher(vch.data(), vch.size());
+    uint256 hashes[CX11NonceHasher::BATCH_SIZE];
+    uint32_t nNonce = 0;
+    while (state.KeepRunning()) {
+        for (uint32_t i = 0; i < NONCE_SCAN_SIZE; i += CX11NonceHasher::BATCH_SIZE) {
+            hasher.Hash(nNonce, CX11NonceHasher::BATCH_SIZE, hashes[0].begin());
+            nNonce += CX11NonceHasher::BATCH_SIZE;
+        }
+    }
+}
+
 BENCHMARK(HASH_RIPEMD160);
 BENCHMARK(HASH_SHA1);
 BENCHMARK(HASH_SHA256);
@@ -235,6 +282,9 @@ BENCHMARK(HASH_DSHA256_0128b_single);
 BENCHMARK(HASH_DSHA256_0512b_single);
 BENCHMARK(HASH_DSHA256_1024b_single);
 BENCHMARK(HASH_DSHA256_2048b_single);
+BENCHMARK(HASH_X11_NonceScan_GetHash);
+BENCHMARK(HASH_X11_NonceScan_Batch);
+
 BENCHMARK(HASH_X11_0032b_single);
 BENCHMARK(HASH_X11_0080b_single);
 BENCHMARK(HASH_X11_0128b_single);
@@ -0,0 +1,96 @@
+// Copyright (c) 2020 The Ion Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "chainparams.h"
+#include "consensus/validation.h"
+#include "fs.h"
+#include "key.h"
+#include "miner.h"
+#include "pow.h"
+#include "primitives/block.h"
+#include "random.h"
+#include "scheduler.h"
+#include "script/sigcache.h"
+#include "streams.h"
+#include "txdb.h"
+#include "util.h"
+#include "validation.h"
+#include "validationinterface.h"
+
+#include "evo/deterministicmns.h"
+#include "evo/evodb.h"
+#include "llmq/quorums_init.h"
+
+// Processes regtest blocks as they arrive from the network, which hashes their header once and
+// passes the hash along validation. Every iteration mines a block on top of the tip and processes a
+// deserialized copy of it, so the timing includes creating the block.
+static void ProcessNewBlockFromNetwork(benchmark::State& state)
+{
+    SelectParams(CBaseChainParams::REGTEST);
+    const CChainParams& chainparams = Params();
+    InitSignatureCache();
+    InitScriptExecutionCache();
+
+    ClearDatadirCache();
+    fs::path pathTemp = fs::temp_directory_path() / strprintf("bench_ion_%lu_%i", (unsigned long)GetTime(), (int)GetRandInt(100000));
+    fs::create_directories(pathTemp);
+    gArgs.ForceSetArg("-datadir", pathTemp.string());
+
+    CScheduler scheduler;
+    GetMainSignals().RegisterBackgroundSignalScheduler(scheduler);
+    evoDb = new CEvoDB(1 << 20, true, true);
+    deterministicMNManager = new CDeterministicMNManager(*evoDb);
+    pblocktree = new CBlockTreeDB(1 << 20, true);
+    CCoinsViewDB* pcoinsdbview = new CCoinsViewDB(1 << 23, true);
+    llmq::InitLLMQSystem(*evoDb, nullptr, true);
+    pcoinsTip = new CCoinsViewCache(pcoinsdbview);
+    CValidationState validationState;
+    bool fLoaded = LoadGenesisBlock(chainparams) && ActivateBestChain(validationState, chainparams);
+    assert(fLoaded);
+
+    CKey coinbaseKey;
+    coinbaseKey.MakeNewKey(true);
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+
+    while (state.KeepRunning()) {
+        std::unique_ptr<CBlockTemplate> pblocktemplate = BlockAssembler(chainparams).CreateNewBlock(scriptPubKey);
+        CBlock& block = pblocktemplate->block;
+        unsigned int nExtraNonce = 0;
+        {
+            LOCK(cs_main);
+            IncrementExtraNonce(&block, chainActive.Tip(), nExtraNonce);
+        }
+        while (!CheckProofOfWork(block.GetHash(), block.nBits, chainparams.GetConsensus())) ++block.nNonce;
+
+        // The template was already checked, a block from the network comes without that state
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        ss << block;
+        auto pblock = std::make_shared<CBlock>();
+        ss >> *pblock;
+
+        bool fProcessed = ProcessNewBlock(chainparams, pblock, true, nullptr);
+        assert(fProcessed);
+    }
+
+    llmq::InterruptLLMQSystem();
+    GetMainSignals().FlushBackgroundCallbacks();
+    GetMainSignals().UnregisterBackgroundSignalScheduler();
+    deterministicMNManager->StopWarmup();
+    UnloadBlockIndex();
+    delete pcoinsTip;
+    pcoinsTip = nullptr;
+    llmq::DestroyLLMQSystem();
+    delete pcoinsdbview;
+    delete pblocktree;
+    pblocktree = nullptr;
+    delete deterministicMNManager;
+    deterministicMNManager = nullptr;
+    delete evoDb;
+    evoDb = nullptr;
+    fs::remove_all(pathTemp);
+}
+
+BENCHMARK(ProcessNewBlockFromNetwork);
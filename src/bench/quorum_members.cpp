@@ -0,0 +1,85 @@
+// Copyright (c) 2020 The Ion Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "evo/deterministicmns.h"
+#include "evo/evodb.h"
+#include "llmq/quorums_utils.h"
+#include "random.h"
+
+static const int MN_COUNT = 2000;
+
+// Runs func with a masternode list of MN_COUNT confirmed masternodes at a fake quorum block
+static void RunWithMNList(const std::function<void(const CBlockIndex*)>& func)
+{
+    SelectParams(CBaseChainParams::MAIN);
+
+    FastRandomContext rnd(true);
+    uint256 quorumHash = rnd.rand256();
+    CBlockIndex quorumIndex;
+    quorumIndex.phashBlock = &quorumHash;
+    quorumIndex.nHeight = 1000;
+
+    CDeterministicMNList mnList(quorumHash, quorumIndex.nHeight, MN_COUNT);
+    for (int i = 0; i < MN_COUNT; i++) {
+        auto dmn = std::make_shared<CDeterministicMN>();
+        dmn->proTxHash = rnd.rand256();
+        dmn->internalId = i;
+        dmn->collateralOutpoint = COutPoint(rnd.rand256(), 0);
+        dmn->nOperatorReward = 0;
+        auto state = std::make_shared<CDeterministicMNState>();
+        state->keyIDOwner = CKeyID(uint160(rnd.randbytes(20)));
+        state->UpdateConfirmedHash(dmn->proTxHash, rnd.rand256());
+        dmn->pdmnState = state;
+        mnList.AddMN(dmn);
+    }
+
+    CEvoDB* oldEvoDb = evoDb;
+    CDeterministicMNManager* oldManager = deterministicMNManager;
+    {
+        CEvoDB benchEvoDb(1 << 20, true, true);
+        // same key as used by CDeterministicMNManager for snapshots
+        benchEvoDb.Write(std::make_pair(std::string("dmn_S"), quorumHash), mnList);
+        CDeterministicMNManager benchManager(benchEvoDb);
+        evoDb = &benchEvoDb;
+        deterministicMNManager = &benchManager;
+
+        func(&quorumIndex);
+
+        llmq::CLLMQUtils::InvalidateQuorumMembersCache();
+    }
+    evoDb = oldEvoDb;
+    deterministicMNManager = oldManager;
+}
+
+// A member asking for its connections of a quorum it is already connected to, e.g. when
+// re-checking connections on every new block
+static void QuorumConnectionsCached(benchmark::State& state)
+{
+    RunWithMNList([&](const CBlockIndex* pindexQuorum) {
+        auto members = llmq::CLLMQUtils::GetAllQuorumMembers(Consensus::LLMQ_400_60, pindexQuorum);
+        size_t i = 0;
+        while (state.KeepRunning()) {
+            llmq::CLLMQUtils::GetQuorumConnections(Consensus::LLMQ_400_60, pindexQuorum, members[i++ % members.size()]->proTxHash);
+        }
+    });
+}
+
+// Every call scores and sorts the whole masternode list, as before caching was added
+static void QuorumConnectionsUncached(benchmark::State& state)
+{
+    RunWithMNList([&](const CBlockIndex* pindexQuorum) {
+        auto members = llmq::CLLMQUtils::GetAllQuorumMembers(Consensus::LLMQ_400_60, pindexQuorum);
+        size_t i = 0;
+        while (state.KeepRunning()) {
+            llmq::CLLMQUtils::InvalidateQuorumMembersCache();
+            llmq::CLLMQUtils::GetQuorumConnections(Consensus::LLMQ_400_60, pindexQuorum, members[i++ % members.size()]->proTxHash);
+        }
+    });
+}
+
+BENCHMARK(QuorumConnectionsCached);
+BENCHMARK(QuorumConnectionsUncached);
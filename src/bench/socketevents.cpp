@@ -0,0 +1,73 @@
+// Copyright (c) 2020 The Ion Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "socketevents.h"
+#include "util.h"
+
+#ifndef WIN32
+#include <sys/socket.h>
+
+// Simulates one iteration of the socket handler loop: every peer socket is set, the
+// registration is swept and one peer has data waiting, so the wait returns immediately
+// and the measured time is the overhead of the backend for the number of peers.
+static void SocketEventsLoop(benchmark::State& state, SocketEventsMode mode, int nPeers)
+{
+    RaiseFileDescriptorLimit(2 * nPeers + 100);
+
+    std::vector<std::pair<SOCKET, SOCKET>> vSocketPairs;
+    for (int i = 0; i < nPeers; i++) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+            break;
+        vSocketPairs.emplace_back(fds[0], fds[1]);
+    }
+    // The last peer sent a message that is never read
+    if (!vSocketPairs.empty())
+        send(vSocketPairs.back().second, "x", 1, 0);
+
+    std::unique_ptr<CSocketEvents> socketEvents = CSocketEvents::Create(mode);
+    std::unordered_map<SOCKET, uint8_t> mapReady;
+    if (socketEvents) {
+        while (state.KeepRunning()) {
+            for (size_t i = 0; i < vSocketPairs.size(); i++)
+                socketEvents->Set(vSocketPairs[i].first, i, SOCKET_EVENT_RECV);
+            socketEvents->Sweep();
+            socketEvents->Wait(50, mapReady);
+            assert(mapReady.size() == 1);
+        }
+    }
+
+    for (const auto& socketPair : vSocketPairs) {
+        close(socketPair.first);
+        close(socketPair.second);
+    }
+}
+
+#ifdef USE_POLL
+static void SocketEventsPoll10(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_POLL, 10); }
+static void SocketEventsPoll100(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_POLL, 100); }
+static void SocketEventsPoll1000(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_POLL, 1000); }
+
+BENCHMARK(SocketEventsPoll10);
+BENCHMARK(SocketEventsPoll100);
+BENCHMARK(SocketEventsPoll1000);
+#else
+static void SocketEventsSelect10(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_SELECT, 10); }
+static void SocketEventsSelect100(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_SELECT, 100); }
+
+BENCHMARK(SocketEventsSelect10);
+BENCHMARK(SocketEventsSelect100);
+#endif
+
+#ifdef USE_EPOLL
+static void SocketEventsEpoll10(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_EPOLL, 10); }
+static void SocketEventsEpoll100(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_EPOLL, 100); }
+static void SocketEventsEpoll1000(benchmark::State& state) { SocketEventsLoop(state, SOCKETEVENTS_EPOLL, 1000); }
+
+BENCHMARK(SocketEventsEpoll10);
+BENCHMARK(SocketEventsEpoll100);
+BENCHMARK(SocketEventsEpoll1000);
+#endif
+#endif // WIN32
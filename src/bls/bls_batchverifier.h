@@ -6,8 +6,14 @@
 #define ION_CRYPTO_BLS_BATCHVERIFIER_H
 
 #include "bls.h"
+#include "bls_worker.h"
 
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <vector>
 
 template<typename SourceId, typename MessageId>
@@ -24,10 +30,31 @@ private:
     typedef std::map<MessageId, Message> MessageMap;
     typedef typename MessageMap::iterator MessageMapIterator;
     typedef std::map<SourceId, std::vector<MessageMapIterator>> MessagesBySourceMap;
+    typedef typename MessagesBySourceMap::const_iterator SourceIterator;
+
+    // [begin, end) of the messages to verify in one aggregated batch
+    typedef std::pair<size_t, size_t> SubBatch;
+
+    // Shared with the worker threads. A helper might only start after Verify() returned, it then finds nothing
+    // left to do and never touches the verifier.
+    struct VerifyState {
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::deque<SubBatch> pending;
+        size_t inProgress{0};
+        int helpers{0};
+        int maxHelpers{0};
+        std::vector<size_t> badIndexes;
+        std::vector<SourceIterator> badSourceIts;
+    };
+
+    // Messages are only split up into sub-batches of at least this size to spread them over the worker threads
+    static const size_t MIN_PARALLEL_SUB_BATCH_SIZE = 16;
 
     bool secureVerification;
     bool perMessageFallback;
     size_t subBatchSize;
+    CBLSWorker* worker;
 
     MessageMap messages;
     MessagesBySourceMap messagesBySource;
@@ -37,10 +64,12 @@ public:
     std::set<MessageId> badMessages;
 
 public:
-    CBLSBatchVerifier(bool _secureVerification, bool _perMessageFallback, size_t _subBatchSize = 0) :
+    // If a worker is given, sub-batches are verified on its threads in parallel with the calling thread
+    CBLSBatchVerifier(bool _secureVerification, bool _perMessageFallback, size_t _subBatchSize = 0, CBLSWorker* _worker = nullptr) :
             secureVerification(_secureVerification),
             perMessageFallback(_perMessageFallback),
-            subBatchSize(_subBatchSize)
+            subBatchSize(_subBatchSize),
+            worker(_worker)
     {
     }
 
@@ -65,56 +94,130 @@ public:
 
     void Verify()
     {
-        std::map<uint256, std::vector<MessageMapIterator>> byMessageHash;
+        if (messages.empty()) {
+            return;
+        }
+
+        // Keep the messages of a source together, so that a source sending only bad messages is found in a few steps.
+        // Without the per-message fallback, each source keeps all of its messages, even those pushed by other sources
+        // as well. A failed sub-batch within a single source then settles that source as bad.
+        std::vector<MessageMapIterator> msgIts;
+        std::vector<SourceIterator> msgSourceIts;
+        std::set<MessageId> added;
+        msgIts.reserve(messages.size());
+        msgSourceIts.reserve(messages.size());
+        for (auto it = messagesBySource.cbegin(); it != messagesBySource.cend(); ++it) {
+            for (const auto& msgIt : it->second) {
+                if (!perMessageFallback || added.emplace(msgIt->first).second) {
+                    msgIts.emplace_back(msgIt);
+                    msgSourceIts.emplace_back(it);
+                }
+            }
+        }
 
-        for (auto it = messages.begin(); it != messages.end(); ++it) {
-            byMessageHash[it->second.msgHash].emplace_back(it);
+        auto state = std::make_shared<VerifyState>();
+        state->maxHelpers = worker ? worker->GetWorkerCount() : 0;
+
+        // Without workers, this starts with the full batch just like a non-parallel verification would
+        size_t subBatchCount = std::min<size_t>(state->maxHelpers + 1, msgIts.size() / MIN_PARALLEL_SUB_BATCH_SIZE);
+        subBatchCount = std::max<size_t>(subBatchCount, 1);
+        {
+            std::unique_lock<std::mutex> l(state->mutex);
+            for (size_t i = 0; i < subBatchCount; i++) {
+                state->pending.emplace_back(msgIts.size() * i / subBatchCount, msgIts.size() * (i + 1) / subBatchCount);
+            }
+            SpawnHelpers(state, msgIts, msgSourceIts);
+        }
+
+        ProcessSubBatches(state, msgIts, msgSourceIts, true);
+
+        for (const auto& sourceIt : state->badSourceIts) {
+            badSources.emplace(sourceIt->first);
         }
 
-        if (VerifyBatch(byMessageHash)) {
-            // full batch is valid
+        std::set<MessageId> badMsgIds;
+        for (size_t idx : state->badIndexes) {
+            badMsgIds.emplace(msgIts[idx]->first);
+        }
+        if (badMsgIds.empty()) {
             return;
         }
 
-        // revert to per-source verification
+        // the same message might have been pushed by multiple sources, all of them are bad
         for (const auto& p : messagesBySource) {
-            bool batchValid = false;
+            for (const auto& msgIt : p.second) {
+                if (badMsgIds.count(msgIt->first)) {
+                    badSources.emplace(p.first);
+                    break;
+                }
+            }
+        }
+        if (perMessageFallback) {
+            badMessages.insert(badMsgIds.begin(), badMsgIds.end());
+        }
+    }
+
+private:
+    // state->mutex must be held while calling
+    void SpawnHelpers(const std::shared_ptr<VerifyState>& state, const std::vector<MessageMapIterator>& msgIts, const std::vector<SourceIterator>& msgSourceIts)
+    {
+        // the current thread picks up one of the pending sub-batches itself
+        while (state->helpers < state->maxHelpers && (size_t)state->helpers + 1 < state->pending.size()) {
+            state->helpers++;
+            worker->AsyncRun([this, state, &msgIts, &msgSourceIts]() {
+                ProcessSubBatches(state, msgIts, msgSourceIts, false);
+            });
+        }
+    }
 
-            // no need to verify it again if there was just one source
-            if (messagesBySource.size() != 1) {
-                byMessageHash.clear();
-                for (auto it = p.second.begin(); it != p.second.end(); ++it) {
-                    byMessageHash[(*it)->second.msgHash].emplace_back(*it);
+    // Verifies pending sub-batches until none are left. A failed sub-batch is split in halves, which are verified again
+    // until the invalid messages are found, or without the per-message fallback, until it lies within a single source.
+    // Only the calling thread of Verify() waits for sub-batches in progress.
+    void ProcessSubBatches(const std::shared_ptr<VerifyState>& state, const std::vector<MessageMapIterator>& msgIts,
+                           const std::vector<SourceIterator>& msgSourceIts, bool fWait)
+    {
+        std::unique_lock<std::mutex> l(state->mutex);
+        while (true) {
+            if (fWait) {
+                state->cond.wait(l, [&]() { return !state->pending.empty() || state->inProgress == 0; });
+            }
+            if (state->pending.empty()) {
+                if (!fWait) {
+                    state->helpers--;
                 }
-                batchValid = VerifyBatch(byMessageHash);
+                return;
+            }
+
+            SubBatch subBatch = state->pending.front();
+            state->pending.pop_front();
+            state->inProgress++;
+            l.unlock();
+
+            std::map<uint256, std::vector<MessageMapIterator>> byMessageHash;
+            for (size_t i = subBatch.first; i < subBatch.second; i++) {
+                byMessageHash[msgIts[i]->second.msgHash].emplace_back(msgIts[i]);
             }
-            if (!batchValid) {
-                badSources.emplace(p.first);
-
-                if (perMessageFallback) {
-                    // revert to per-message verification
-                    if (p.second.size() == 1) {
-                        // no need to re-verify a single message
-                        badMessages.emplace(p.second[0]->second.msgId);
-                    } else {
-                        for (const auto& msgIt : p.second) {
-                            if (badMessages.count(msgIt->first)) {
-                                // same message might be invalid from different source, so no need to re-verify it
-                                continue;
-                            }
-
-                            const auto& msg = msgIt->second;
-                            if (!msg.sig.VerifyInsecure(msg.pubKey, msg.msgHash)) {
-                                badMessages.emplace(msg.msgId);
-                            }
-                        }
-                    }
+            bool valid = VerifyBatch(byMessageHash);
+
+            l.lock();
+            state->inProgress--;
+            if (!valid) {
+                if (!perMessageFallback && msgSourceIts[subBatch.first] == msgSourceIts[subBatch.second - 1]) {
+                    // messages of a source are adjacent, only the bad sources are needed
+                    state->badSourceIts.emplace_back(msgSourceIts[subBatch.first]);
+                } else if (subBatch.second - subBatch.first == 1) {
+                    state->badIndexes.emplace_back(subBatch.first);
+                } else {
+                    size_t middle = subBatch.first + (subBatch.second - subBatch.first) / 2;
+                    state->pending.emplace_back(subBatch.first, middle);
+                    state->pending.emplace_back(middle, subBatch.second);
+                    SpawnHelpers(state, msgIts, msgSourceIts);
                 }
             }
+            state->cond.notify_all();
         }
     }
 
-private:
     // All Verify methods take ownership of the passed byMessageHash map and thus might modify the map. This is to avoid
     // unnecessary copies
 
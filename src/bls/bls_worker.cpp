@@ -887,6 +887,18 @@ bool CBLSWorker::IsAsyncVerifyInProgress()
     return sigVerifyBatchesInProgress != 0;
 }
 
+void CBLSWorker::AsyncRun(std::function<void()> job)
+{
+    workerPool.push([job](int threadId) {
+        job();
+    });
+}
+
+int CBLSWorker::GetWorkerCount()
+{
+    return workerPool.size();
+}
+
 // sigVerifyMutex must be held while calling
 void CBLSWorker::PushSigVerifyBatch()
 {
@@ -139,6 +139,10 @@ public:
     std::future<bool> AsyncVerifySig(const CBLSSignature& sig, const CBLSPublicKey& pubKey, const uint256& msgHash, CancelCond cancelCond = [] { return false; });
     bool IsAsyncVerifyInProgress();
 
+    // Runs a job on the worker threads, used by CBLSBatchVerifier to verify sub-batches in parallel
+    void AsyncRun(std::function<void()> job);
+    int GetWorkerCount();
+
 private:
     void PushSigVerifyBatch();
 };
@@ -58,6 +58,15 @@
 #include <unistd.h>
 #endif
 
+#if !defined(WIN32) && defined(HAVE_POLL_H)
+#define USE_POLL
+#include <poll.h>
+#endif
+
+#if defined(USE_POLL) && defined(HAVE_SYS_EPOLL_H)
+#define USE_EPOLL
+#endif
+
 #ifndef WIN32
 typedef unsigned int SOCKET;
 #include "errno.h"
@@ -88,7 +97,7 @@ size_t strnlen( const char *start, size_t max_len);
 #endif // HAVE_DECL_STRNLEN
 
 bool static inline IsSelectableSocket(const SOCKET& s) {
-#ifdef WIN32
+#if defined(WIN32) || defined(USE_POLL)
     return true;
 #else
     return (s < FD_SETSIZE);
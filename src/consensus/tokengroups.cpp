@@ -13,23 +13,56 @@
 
 std::shared_ptr<CTokenGroupManager> tokenGroupManager;
 
-bool IsTokenManagementKey(CScript script) {
+CTokenGroupInfoCache tokenGroupInfoCache;
+
+// Whether the third opcode is OP_GROUP, CTokenGroupInfo parses every other script as ungrouped
+static bool HasGroupOpcode(const CScript& script)
+{
+    CScript::const_iterator pc = script.begin();
+    opcodetype opcode = OP_INVALIDOPCODE;
+    for (int i = 0; i < 3; i++) {
+        if (!script.GetOp(pc, opcode))
+            return false;
+    }
+    return opcode == OP_GROUP;
+}
+
+CTokenGroupInfoRef CTokenGroupInfoCache::Get(const COutPoint& outpoint, const CScript& script)
+{
+    static const CTokenGroupInfoRef noGroupInfo = std::make_shared<const CTokenGroupInfo>(NoGroup, 0);
+    if (!HasGroupOpcode(script))
+        return noGroupInfo;
+
+    LOCK(cs);
+    auto it = mapTokenGroupInfo.find(outpoint);
+    if (it != mapTokenGroupInfo.end())
+        return it->second;
+
+    CTokenGroupInfoRef tokenGrp = std::make_shared<const CTokenGroupInfo>(script);
+    mapTokenGroupInfo.emplace(outpoint, tokenGrp);
+    queueInserted.push_back(outpoint);
+    while (queueInserted.size() > MAX_TOKEN_GROUP_INFO_CACHE_SIZE) {
+        mapTokenGroupInfo.erase(queueInserted.front());
+        queueInserted.pop_front();
+    }
+    return tokenGrp;
+}
+
+bool IsTokenManagementKey(const CScript& script) {
     // Initially, the TokenManagementKey enables management token operations
     // When the MagicToken is created, the MagicToken enables management token operations
     if (!tokenGroupManager->MagicTokensCreated()) {
         CTxDestination payeeDest;
-        ExtractDestination(script, payeeDest);
-        return EncodeDestination(payeeDest) == Params().GetConsensus().strTokenManagementKey;
+        return ExtractDestination(script, payeeDest) && payeeDest == tokenGroupManager->GetTokenManagementKeyDest();
     }
     return false;
 }
 
-bool IsMagicInput(CScript script) {
+static bool IsMagicInput(const CTokenGroupInfo& tokenGrp) {
     // Initially, the TokenManagementKey enables management token operations
     // When the MagicToken is created, the MagicToken enables management token operations
     if (tokenGroupManager->MagicTokensCreated()) {
-        CTokenGroupInfo grp(script);
-        return grp.associatedGroup == tokenGroupManager->GetMagicID();
+        return tokenGrp.associatedGroup == tokenGroupManager->GetMagicID();
     }
     return false;
 }
@@ -54,14 +87,12 @@ bool AnyInputsGrouped(const CTransaction &transaction, const int nHeight, const
                 // no prior coins can be grouped.
                 if (coin.nHeight < Params().GetConsensus().ATPStartHeight)
                     continue;
-                const CScript &script = coin.out.scriptPubKey;
-
-                CTokenGroupInfo tokenGrp(script);
+                const CTokenGroupInfoRef tokenGrp = tokenGroupInfoCache.Get(prevout, coin.out.scriptPubKey);
                 // The prevout should never be invalid because that would mean that this node accepted a block with an
                 // invalid OP_GROUP tx in it.
-                if (tokenGrp.invalid)
+                if (tokenGrp->invalid)
                     continue;
-                if (tokenGrp.associatedGroup == tgID) {
+                if (tokenGrp->associatedGroup == tgID) {
                     LogPrint(BCLog::TOKEN, "%s - Matched a TokenGroup input: [%s] at height [%d]\n", __func__, coin.out.ToString(), coin.nHeight);
                     anyInputsGrouped = true;
                 }
@@ -82,33 +113,34 @@ bool CheckTokenGroups(const CTransaction &tx, CValidationState &state, const CCo
     CScript firstOpReturn;
 
     // Iterate through all the outputs constructing the final balances of every group.
-    for (const auto &outp : tx.vout)
+    const uint256& txhash = tx.GetHash();
+    for (unsigned int i = 0; i < tx.vout.size(); i++)
     {
-        const CScript &scriptPubKey = outp.scriptPubKey;
-        CTokenGroupInfo tokenGrp(scriptPubKey);
+        const CTxOut &outp = tx.vout[i];
+        const CTokenGroupInfoRef tokenGrp = tokenGroupInfoCache.Get(COutPoint(txhash, i), outp.scriptPubKey);
         if ((outp.nValue == 0) && (firstOpReturn.size() == 0) && (outp.scriptPubKey[0] == OP_RETURN))
         {
             firstOpReturn = outp.scriptPubKey; // Used later if this is a group creation transaction
         }
-        if (tokenGrp.invalid)
+        if (tokenGrp->invalid)
             return state.Invalid(false, REJECT_INVALID, "bad OP_GROUP");
-        if (tokenGrp.associatedGroup != NoGroup)
+        if (tokenGrp->associatedGroup != NoGroup)
         {
-            gBalance[tokenGrp.associatedGroup].numOutputs += 1;
+            gBalance[tokenGrp->associatedGroup].numOutputs += 1;
 
-            if (tokenGrp.quantity > 0)
+            if (tokenGrp->quantity > 0)
             {
-                if (std::numeric_limits<CAmount>::max() - gBalance[tokenGrp.associatedGroup].output < tokenGrp.quantity)
+                if (std::numeric_limits<CAmount>::max() - gBalance[tokenGrp->associatedGroup].output < tokenGrp->quantity)
                     return state.Invalid(false, REJECT_INVALID, "token overflow");
-                gBalance[tokenGrp.associatedGroup].output += tokenGrp.quantity;
+                gBalance[tokenGrp->associatedGroup].output += tokenGrp->quantity;
             }
-            else if (tokenGrp.quantity == 0)
+            else if (tokenGrp->quantity == 0)
             {
                 return state.Invalid(false, REJECT_INVALID, "OP_GROUP quantity is zero");
             }
             else // this is an authority output
             {
-                gBalance[tokenGrp.associatedGroup].ctrlOutputPerms |= (GroupAuthorityFlags)tokenGrp.quantity;
+                gBalance[tokenGrp->associatedGroup].ctrlOutputPerms |= (GroupAuthorityFlags)tokenGrp->quantity;
             }
         }
     }
@@ -132,33 +164,33 @@ bool CheckTokenGroups(const CTransaction &tx, CValidationState &state, const CCo
         if (coin.nHeight < Params().GetConsensus().ATPStartHeight)
             continue;
 
-        anyInputsGroupManagement = anyInputsGroupManagement || IsMagicInput(script);
+        const CTokenGroupInfoRef tokenGrp = tokenGroupInfoCache.Get(prevout, script);
+        anyInputsGroupManagement = anyInputsGroupManagement || IsMagicInput(*tokenGrp);
 
-        CTokenGroupInfo tokenGrp(script);
         // The prevout should never be invalid because that would mean that this node accepted a block with an
         // invalid OP_GROUP tx in it.
-        if (tokenGrp.invalid)
+        if (tokenGrp->invalid)
             continue;
-        CAmount amount = tokenGrp.quantity;
-        if (tokenGrp.controllingGroupFlags() != GroupAuthorityFlags::NONE)
+        CAmount amount = tokenGrp->quantity;
+        if (tokenGrp->controllingGroupFlags() != GroupAuthorityFlags::NONE)
         {
-            auto temp = tokenGrp.controllingGroupFlags();
+            auto temp = tokenGrp->controllingGroupFlags();
             // outputs can have all the permissions of inputs, except for 1 special case
             // If CCHILD is not set, no outputs can be authorities (so unset the CTRL flag)
             if (hasCapability(temp, GroupAuthorityFlags::CCHILD))
             {
-                gBalance[tokenGrp.associatedGroup].allowedCtrlOutputPerms |= temp;
+                gBalance[tokenGrp->associatedGroup].allowedCtrlOutputPerms |= temp;
                 if (hasCapability(temp, GroupAuthorityFlags::SUBGROUP))
-                    gBalance[tokenGrp.associatedGroup].allowedSubgroupCtrlOutputPerms |= temp;
+                    gBalance[tokenGrp->associatedGroup].allowedSubgroupCtrlOutputPerms |= temp;
             }
             // Track what permissions this transaction has
-            gBalance[tokenGrp.associatedGroup].ctrlPerms |= temp;
+            gBalance[tokenGrp->associatedGroup].ctrlPerms |= temp;
         }
-        if ((tokenGrp.associatedGroup != NoGroup) && !tokenGrp.isAuthority())
+        if ((tokenGrp->associatedGroup != NoGroup) && !tokenGrp->isAuthority())
         {
-            if (std::numeric_limits<CAmount>::max() - gBalance[tokenGrp.associatedGroup].input < amount)
+            if (std::numeric_limits<CAmount>::max() - gBalance[tokenGrp->associatedGroup].input < amount)
                 return state.Invalid(false, REJECT_INVALID, "token overflow");
-            gBalance[tokenGrp.associatedGroup].input += amount;
+            gBalance[tokenGrp->associatedGroup].input += amount;
         }
     }
 
@@ -7,10 +7,14 @@
 #define CONSENSUS_TOKEN_GROUPS_H
 
 #include "chainparams.h"
+#include "coins.h"
 #include "consensus/validation.h"
 #include "pubkey.h"
+#include "sync.h"
 #include "tokens/groups.h"
 #include "util.h"
+#include <deque>
+#include <memory>
 #include <unordered_map>
 
 class CCoinsViewCache;
@@ -38,6 +42,32 @@ public:
     uint64_t numOutputs;
 };
 
+/** Maximum number of grouped outputs kept in the token group info cache */
+static const size_t MAX_TOKEN_GROUP_INFO_CACHE_SIZE = 50000;
+
+typedef std::shared_ptr<const CTokenGroupInfo> CTokenGroupInfoRef;
+
+/**
+ * Parsed token group info of recently checked grouped outputs, keyed by outpoint. An outpoint always refers to
+ * the same script, so entries never go stale and outputs checked at mempool acceptance are not parsed again when
+ * they are connected or spent. The oldest entries are dropped first.
+ * Scripts without OP_GROUP, almost all outputs, are recognized from their opcodes and never enter the cache.
+ */
+class CTokenGroupInfoCache
+{
+private:
+    mutable CCriticalSection cs;
+    std::unordered_map<COutPoint, CTokenGroupInfoRef, SaltedOutpointHasher> mapTokenGroupInfo;
+    std::deque<COutPoint> queueInserted;
+
+public:
+    CTokenGroupInfoRef Get(const COutPoint& outpoint, const CScript& script);
+};
+
+extern CTokenGroupInfoCache tokenGroupInfoCache;
+
+bool IsTokenManagementKey(const CScript& script);
+
 // Verify that the token groups in this transaction properly balance
 bool CheckTokenGroups(const CTransaction &tx, CValidationState &state, const CCoinsViewCache &view, std::unordered_map<CTokenGroupID, CTokenGroupBalance>& gBalance);
 
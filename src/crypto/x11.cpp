@@ -0,0 +1,76 @@
+// Copyright (c) 2020 The Ion Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "crypto/x11.h"
+
+#include "crypto/common.h"
+#include "crypto/sph_blake.h"
+#include "crypto/sph_bmw.h"
+#include "crypto/sph_cubehash.h"
+#include "crypto/sph_echo.h"
+#include "crypto/sph_groestl.h"
+#include "crypto/sph_jh.h"
+#include "crypto/sph_keccak.h"
+#include "crypto/sph_luffa.h"
+#include "crypto/sph_shavite.h"
+#include "crypto/sph_simd.h"
+#include "crypto/sph_skein.h"
+
+#include <assert.h>
+#include <string.h>
+
+namespace {
+
+typedef unsigned char Lane[64];
+
+/** Run one 512-bit X11 stage over all lanes of a batch */
+template <typename Ctx, void (*Init)(void*), void (*Update)(void*, const void*, size_t), void (*Close)(void*, void*)>
+void Stage(const Lane* in, Lane* out, size_t count)
+{
+    Ctx ctx;
+    for (size_t i = 0; i < count; i++) {
+        Init(&ctx);
+        Update(&ctx, in[i], sizeof(Lane));
+        Close(&ctx, out[i]);
+    }
+}
+
+} // namespace
+
+CX11NonceHasher::CX11NonceHasher(const unsigned char* data, size_t len) : headerLen(len)
+{
+    assert(len >= NONCE_OFFSET + 4 && len <= MAX_HEADER_SIZE);
+    memcpy(header, data, len);
+}
+
+void CX11NonceHasher::Hash(uint32_t nNonce, size_t count, unsigned char* output)
+{
+    assert(count <= BATCH_SIZE);
+
+    Lane a[BATCH_SIZE], b[BATCH_SIZE];
+
+    sph_blake512_context ctx_blake;
+    for (size_t i = 0; i < count; i++) {
+        WriteLE32(header + NONCE_OFFSET, nNonce + i);
+        sph_blake512_init(&ctx_blake);
+        sph_blake512(&ctx_blake, header, headerLen);
+        sph_blake512_close(&ctx_blake, a[i]);
+    }
+
+    Stage<sph_bmw512_context, sph_bmw512_init, sph_bmw512, sph_bmw512_close>(a, b, count);
+    Stage<sph_groestl512_context, sph_groestl512_init, sph_groestl512, sph_groestl512_close>(b, a, count);
+    Stage<sph_skein512_context, sph_skein512_init, sph_skein512, sph_skein512_close>(a, b, count);
+    Stage<sph_jh512_context, sph_jh512_init, sph_jh512, sph_jh512_close>(b, a, count);
+    Stage<sph_keccak512_context, sph_keccak512_init, sph_keccak512, sph_keccak512_close>(a, b, count);
+    Stage<sph_luffa512_context, sph_luffa512_init, sph_luffa512, sph_luffa512_close>(b, a, count);
+    Stage<sph_cubehash512_context, sph_cubehash512_init, sph_cubehash512, sph_cubehash512_close>(a, b, count);
+    Stage<sph_shavite512_context, sph_shavite512_init, sph_shavite512, sph_shavite512_close>(b, a, count);
+    Stage<sph_simd512_context, sph_simd512_init, sph_simd512, sph_simd512_close>(a, b, count);
+    Stage<sph_echo512_context, sph_echo512_init, sph_echo512, sph_echo512_close>(b, a, count);
+
+    // X11 uses the first 256 bits of the final 512-bit echo digest
+    for (size_t i = 0; i < count; i++) {
+        memcpy(output + i * OUTPUT_SIZE, a[i], OUTPUT_SIZE);
+    }
+}
@@ -0,0 +1,40 @@
+// Copyright (c) 2020 The Ion Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef ION_CRYPTO_X11_H
+#define ION_CRYPTO_X11_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/** Hashes consecutive nonces of a serialized block header with X11.
+ *
+ *  The header is serialized once by the caller and only the nonce bytes are
+ *  patched between hashes. Nonces are hashed in batches of up to BATCH_SIZE,
+ *  running each of the eleven X11 stages over the whole batch before moving on
+ *  to the next one, so the code and lookup tables of each primitive stay hot
+ *  in cache.
+ */
+class CX11NonceHasher
+{
+private:
+    unsigned char header[112];
+    size_t headerLen;
+
+public:
+    static const size_t OUTPUT_SIZE = 32;
+    static const size_t BATCH_SIZE = 8;
+    static const size_t NONCE_OFFSET = 76;
+    static const size_t MAX_HEADER_SIZE = sizeof(header);
+
+    CX11NonceHasher(const unsigned char* data, size_t len);
+
+    /** Hash the header for the nonces nNonce .. nNonce + count - 1.
+     *  output: pointer to a count*32 byte output buffer
+     *  count:  the number of nonces to hash, at most BATCH_SIZE
+     */
+    void Hash(uint32_t nNonce, size_t count, unsigned char* output);
+};
+
+#endif // ION_CRYPTO_X11_H
@@ -22,6 +22,7 @@
 
 static const std::string DB_LIST_SNAPSHOT = "dmn_S";
 static const std::string DB_LIST_DIFF = "dmn_D";
+static const std::string DB_SNAPSHOT_INTERVAL = "dmn_SI";
 
 CDeterministicMNManager* deterministicMNManager;
 
@@ -195,54 +196,33 @@ static int CompareByLastPaid_GetHeight(const CDeterministicMN& dmn)
     return height;
 }
 
-static bool CompareByLastPaid(const CDeterministicMN& _a, const CDeterministicMN& _b)
+// MNs with the lowest key get paid first, ties are broken by proTxHash
+static CDeterministicMNList::MnPayeeIndexKey GetPayeeIndexKey(const CDeterministicMN& dmn)
 {
-    int ah = CompareByLastPaid_GetHeight(_a);
-    int bh = CompareByLastPaid_GetHeight(_b);
-    if (ah == bh) {
-        return _a.proTxHash < _b.proTxHash;
-    } else {
-        return ah < bh;
-    }
-}
-static bool CompareByLastPaid(const CDeterministicMNCPtr& _a, const CDeterministicMNCPtr& _b)
-{
-    return CompareByLastPaid(*_a, *_b);
+    return std::make_pair(CompareByLastPaid_GetHeight(dmn), dmn.proTxHash);
 }
 
 CDeterministicMNCPtr CDeterministicMNList::GetMNPayee() const
 {
-    if (mnMap.size() == 0) {
+    if (mnPayeeIndex.empty()) {
         return nullptr;
     }
-
-    CDeterministicMNCPtr best;
-    ForEachMN(true, [&](const CDeterministicMNCPtr& dmn) {
-        if (!best || CompareByLastPaid(dmn, best)) {
-            best = dmn;
-        }
-    });
-
-    return best;
+    return GetMN(mnPayeeIndex.front().second);
 }
 
 std::vector<CDeterministicMNCPtr> CDeterministicMNList::GetProjectedMNPayees(int nCount) const
 {
-    if (nCount > GetValidMNsCount()) {
-        nCount = GetValidMNsCount();
+    if (nCount > (int)mnPayeeIndex.size()) {
+        nCount = mnPayeeIndex.size();
     }
 
     std::vector<CDeterministicMNCPtr> result;
-    result.reserve(nCount);
+    result.reserve(std::max(nCount, 0));
 
-    ForEachMN(true, [&](const CDeterministicMNCPtr& dmn) {
-        result.emplace_back(dmn);
-    });
-    std::sort(result.begin(), result.end(), [&](const CDeterministicMNCPtr& a, const CDeterministicMNCPtr& b) {
-        return CompareByLastPaid(a, b);
-    });
-
-    result.resize(nCount);
+    auto it = mnPayeeIndex.begin();
+    for (int i = 0; i < nCount; i++, ++it) {
+        result.emplace_back(GetMN(it->second));
+    }
 
     return result;
 }
@@ -431,10 +411,47 @@ CDeterministicMNList CDeterministicMNList::ApplyDiff(const CBlockIndex* pindex,
     return result;
 }
 
+size_t CDeterministicMNList::LowerBoundPayeeIndex(const MnPayeeIndexKey& key) const
+{
+    size_t first = 0;
+    size_t count = mnPayeeIndex.size();
+    while (count > 0) {
+        size_t step = count / 2;
+        if (mnPayeeIndex[first + step] < key) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return first;
+}
+
+void CDeterministicMNList::AddToPayeeIndex(const CDeterministicMNCPtr& dmn)
+{
+    if (!IsMNValid(dmn)) {
+        return;
+    }
+    auto key = GetPayeeIndexKey(*dmn);
+    mnPayeeIndex = mnPayeeIndex.insert(LowerBoundPayeeIndex(key), key);
+}
+
+void CDeterministicMNList::RemoveFromPayeeIndex(const CDeterministicMNCPtr& dmn)
+{
+    if (!IsMNValid(dmn)) {
+        return;
+    }
+    auto key = GetPayeeIndexKey(*dmn);
+    size_t pos = LowerBoundPayeeIndex(key);
+    assert(pos < mnPayeeIndex.size() && mnPayeeIndex[pos] == key);
+    mnPayeeIndex = mnPayeeIndex.erase(pos);
+}
+
 void CDeterministicMNList::AddMN(const CDeterministicMNCPtr& dmn)
 {
     assert(!mnMap.find(dmn->proTxHash));
     mnMap = mnMap.set(dmn->proTxHash, dmn);
+    AddToPayeeIndex(dmn);
     mnInternalIdMap = mnInternalIdMap.set(dmn->internalId, dmn->proTxHash);
     AddUniqueProperty(dmn, dmn->collateralOutpoint);
     if (dmn->pdmnState->addr != CService()) {
@@ -454,6 +471,11 @@ void CDeterministicMNList::UpdateMN(const CDeterministicMNCPtr& oldDmn, const CD
     dmn->pdmnState = pdmnState;
     mnMap = mnMap.set(oldDmn->proTxHash, dmn);
 
+    if (IsMNValid(oldDmn) != IsMNValid(dmn) || GetPayeeIndexKey(*oldDmn) != GetPayeeIndexKey(*dmn)) {
+        RemoveFromPayeeIndex(oldDmn);
+        AddToPayeeIndex(dmn);
+    }
+
     UpdateUniqueProperty(dmn, oldState->addr, pdmnState->addr);
     UpdateUniqueProperty(dmn, oldState->keyIDOwner, pdmnState->keyIDOwner);
     UpdateUniqueProperty(dmn, oldState->pubKeyOperator, pdmnState->pubKeyOperator);
@@ -487,13 +509,33 @@ void CDeterministicMNList::RemoveMN(const uint256& proTxHash)
     if (dmn->pdmnState->pubKeyOperator.Get().IsValid()) {
         DeleteUniqueProperty(dmn, dmn->pdmnState->pubKeyOperator);
     }
+    RemoveFromPayeeIndex(dmn);
     mnMap = mnMap.erase(proTxHash);
     mnInternalIdMap = mnInternalIdMap.erase(dmn->internalId);
 }
 
-CDeterministicMNManager::CDeterministicMNManager(CEvoDB& _evoDb) :
-    evoDb(_evoDb)
+CDeterministicMNManager::CDeterministicMNManager(CEvoDB& _evoDb, int _nSnapshotInterval, size_t _nHistoricalCacheMaxUsage) :
+    evoDb(_evoDb),
+    nSnapshotInterval(std::max(1, _nSnapshotInterval)),
+    nHistoricalCacheMaxUsage(_nHistoricalCacheMaxUsage)
 {
+    warmupPool.resize(1);
+    RenameThreadPool(warmupPool, "ion-dmn-warmup");
+}
+
+CDeterministicMNManager::~CDeterministicMNManager()
+{
+    StopWarmup();
+}
+
+void CDeterministicMNManager::StopWarmup()
+{
+    {
+        LOCK(cs);
+        fWarmupStopped = true;
+    }
+    // the running warm-up needs cs
+    warmupPool.stop(false);
 }
 
 bool CDeterministicMNManager::ProcessBlock(const CBlock& block, const CBlockIndex* pindex, CValidationState& _state, bool fJustCheck)
@@ -532,7 +574,7 @@ bool CDeterministicMNManager::ProcessBlock(const CBlock& block, const CBlockInde
         diff = oldList.BuildDiff(newList);
 
         evoDb.Write(std::make_pair(DB_LIST_DIFF, newList.GetBlockHash()), diff);
-        if ((nHeight % SNAPSHOT_LIST_PERIOD) == 0 || oldList.GetHeight() == -1) {
+        if ((nHeight % nSnapshotInterval) == 0 || oldList.GetHeight() == -1) {
             evoDb.Write(std::make_pair(DB_LIST_SNAPSHOT, newList.GetBlockHash()), newList);
             LogPrintf("CDeterministicMNManager::%s -- Wrote snapshot. nHeight=%d, mapCurMNs.allMNsCount=%d\n",
                 __func__, nHeight, newList.GetAllMNsCount());
@@ -582,8 +624,12 @@ bool CDeterministicMNManager::UndoBlock(const CBlock& block, const CBlockIndex*
         evoDb.Erase(std::make_pair(DB_LIST_SNAPSHOT, blockHash));
 
         mnListsCache.erase(blockHash);
+        EraseHistoricalList(blockHash);
     }
 
+    // quorum members were calculated from lists which might have been built on top of this block
+    llmq::CLLMQUtils::InvalidateQuorumMembersCache();
+
     if (diff.HasChanges()) {
         auto inversedDiff = curList.BuildDiff(prevList);
         GetMainSignals().NotifyMasternodeListChanged(true, curList, inversedDiff);
@@ -603,6 +649,51 @@ void CDeterministicMNManager::UpdatedBlockTip(const CBlockIndex* pindex)
     LOCK(cs);
 
     tipIndex = pindex;
+    ScheduleWarmup(pindex);
+}
+
+void CDeterministicMNManager::ScheduleWarmup(const CBlockIndex* pindex)
+{
+    AssertLockHeld(cs);
+
+    const auto& consensusParams = Params().GetConsensus();
+
+    // the set of active quorums only changes when a new DKG starts
+    bool fQuorumStarted = nLastWarmupHeight == -1;
+    for (const auto& p : consensusParams.llmqs) {
+        if (pindex->nHeight % p.second.dkgInterval == 0) {
+            fQuorumStarted = true;
+        }
+    }
+    if (fWarmupStopped || !fQuorumStarted || pindex->nHeight == nLastWarmupHeight) {
+        return;
+    }
+    nLastWarmupHeight = pindex->nHeight;
+
+    std::vector<const CBlockIndex*> vQuorumIndexes;
+    for (const auto& p : consensusParams.llmqs) {
+        const auto& params = p.second;
+        int nQuorumHeight = pindex->nHeight - (pindex->nHeight % params.dkgInterval);
+        // one more than the active ones, as signing accepts it too
+        for (int i = 0; i <= params.signingActiveQuorumCount && nQuorumHeight >= consensusParams.DIP0003Height; i++) {
+            vQuorumIndexes.emplace_back(pindex->GetAncestor(nQuorumHeight));
+            nQuorumHeight -= params.dkgInterval;
+        }
+    }
+    if (vQuorumIndexes.empty()) {
+        return;
+    }
+
+    warmupPool.push([this, vQuorumIndexes](int threadId) {
+        for (const auto* pindexQuorum : vQuorumIndexes) {
+            LOCK(cs);
+            // don't cache a list for a block which was disconnected in the meantime
+            if (!evoDb.Exists(std::make_pair(DB_LIST_DIFF, pindexQuorum->GetBlockHash()))) {
+                continue;
+            }
+            GetListForBlock(pindexQuorum);
+        }
+    });
 }
 
 bool CDeterministicMNManager::BuildNewListFromBlock(const CBlock& block, const CBlockIndex* pindexPrev, CValidationState& _state, CDeterministicMNList& mnListRet, bool debugLogs)
@@ -888,16 +979,22 @@ CDeterministicMNList CDeterministicMNManager::GetListForBlock(const CBlockIndex*
     CDeterministicMNList snapshot;
     std::list<std::pair<const CBlockIndex*, CDeterministicMNListDiff>> listDiff;
 
+    // lists of recent blocks are pinned, older lists only go into the historical LRU when they were requested
+    int nPinnedHeight = tipIndex ? tipIndex->nHeight - LISTS_CACHE_SIZE : -1;
+    const uint256 requestedHash = pindex->GetBlockHash();
+
     while (true) {
         // try using cache before reading from disk
-        auto it = mnListsCache.find(pindex->GetBlockHash());
-        if (it != mnListsCache.end()) {
-            snapshot = it->second;
+        if (GetCachedList(pindex->GetBlockHash(), snapshot)) {
             break;
         }
 
         if (evoDb.Read(std::make_pair(DB_LIST_SNAPSHOT, pindex->GetBlockHash()), snapshot)) {
-            mnListsCache.emplace(pindex->GetBlockHash(), snapshot);
+            if (pindex->nHeight >= nPinnedHeight) {
+                mnListsCache.emplace(pindex->GetBlockHash(), snapshot);
+            } else {
+                AddHistoricalList(snapshot);
+            }
             break;
         }
 
@@ -922,12 +1019,65 @@ CDeterministicMNList CDeterministicMNManager::GetListForBlock(const CBlockIndex*
             snapshot.SetHeight(diffIndex->nHeight);
         }
 
-        mnListsCache.emplace(diffIndex->GetBlockHash(), snapshot);
+        if (diffIndex->nHeight >= nPinnedHeight) {
+            mnListsCache.emplace(diffIndex->GetBlockHash(), snapshot);
+        } else if (diffIndex->GetBlockHash() == requestedHash) {
+            AddHistoricalList(snapshot);
+        }
     }
 
     return snapshot;
 }
 
+bool CDeterministicMNManager::GetCachedList(const uint256& blockHash, CDeterministicMNList& mnListRet)
+{
+    AssertLockHeld(cs);
+
+    auto it = mnListsCache.find(blockHash);
+    if (it != mnListsCache.end()) {
+        mnListRet = it->second;
+        return true;
+    }
+
+    auto itHistorical = historicalListsCache.find(blockHash);
+    if (itHistorical != historicalListsCache.end()) {
+        historicalListsOrder.splice(historicalListsOrder.begin(), historicalListsOrder, itHistorical->second.second);
+        mnListRet = itHistorical->second.first;
+        return true;
+    }
+    return false;
+}
+
+void CDeterministicMNManager::AddHistoricalList(const CDeterministicMNList& mnList)
+{
+    AssertLockHeld(cs);
+
+    if (historicalListsCache.count(mnList.GetBlockHash())) {
+        return;
+    }
+
+    historicalListsOrder.emplace_front(mnList.GetBlockHash());
+    historicalListsCache.emplace(mnList.GetBlockHash(), std::make_pair(mnList, historicalListsOrder.begin()));
+    nHistoricalCacheUsage += (mnList.GetAllMNsCount() + 1) * LIST_ENTRY_MEMORY_USAGE;
+
+    while (nHistoricalCacheUsage > nHistoricalCacheMaxUsage && historicalListsOrder.size() > 1) {
+        EraseHistoricalList(historicalListsOrder.back());
+    }
+}
+
+void CDeterministicMNManager::EraseHistoricalList(const uint256& blockHash)
+{
+    AssertLockHeld(cs);
+
+    auto it = historicalListsCache.find(blockHash);
+    if (it == historicalListsCache.end()) {
+        return;
+    }
+    nHistoricalCacheUsage -= (it->second.first.GetAllMNsCount() + 1) * LIST_ENTRY_MEMORY_USAGE;
+    historicalListsOrder.erase(it->second.second);
+    historicalListsCache.erase(it);
+}
+
 CDeterministicMNList CDeterministicMNManager::GetListAtChainTip()
 {
     LOCK(cs);
@@ -1076,7 +1226,7 @@ void CDeterministicMNManager::UpgradeDBIfNeeded()
         CDeterministicMNList newMNList;
         UpgradeDiff(batch, pindex, curMNList, newMNList);
 
-        if ((nHeight % SNAPSHOT_LIST_PERIOD) == 0) {
+        if ((nHeight % nSnapshotInterval) == 0) {
             batch.Write(std::make_pair(DB_LIST_SNAPSHOT, pindex->GetBlockHash()), newMNList);
             evoDb.GetRawDB().WriteBatch(batch);
             batch.Clear();
@@ -1085,6 +1235,8 @@ void CDeterministicMNManager::UpgradeDBIfNeeded()
         curMNList = newMNList;
     }
 
+    // the snapshots were just written with the configured interval
+    batch.Write(DB_SNAPSHOT_INTERVAL, nSnapshotInterval);
     evoDb.GetRawDB().WriteBatch(batch);
 
     LogPrintf("CDeterministicMNManager::%s -- done upgrading\n", __func__);
@@ -1096,3 +1248,68 @@ void CDeterministicMNManager::UpgradeDBIfNeeded()
 
     evoDb.GetRawDB().CompactFull();
 }
+
+void CDeterministicMNManager::MigrateSnapshotIntervalIfNeeded()
+{
+    LOCK2(cs_main, cs);
+
+    if (chainActive.Tip() == nullptr) {
+        // new DB, everything will be written with the current interval
+        evoDb.GetRawDB().Write(DB_SNAPSHOT_INTERVAL, nSnapshotInterval);
+        return;
+    }
+
+    // DBs written before the interval was configurable used a fixed interval
+    int nOldInterval = DEFAULT_DMN_SNAPSHOT_INTERVAL;
+    evoDb.GetRawDB().Read(DB_SNAPSHOT_INTERVAL, nOldInterval);
+    if (nOldInterval == nSnapshotInterval) {
+        return;
+    }
+
+    LogPrintf("CDeterministicMNManager::%s -- changing snapshot interval from %d to %d blocks\n", __func__, nOldInterval, nSnapshotInterval);
+
+    // walk the active chain by applying diffs, which doesn't depend on the snapshots which are being rewritten
+    int nStartHeight = std::max(1, Params().GetConsensus().DIP0003Height);
+    if (nStartHeight > chainActive.Height()) {
+        evoDb.GetRawDB().Write(DB_SNAPSHOT_INTERVAL, nSnapshotInterval);
+        return;
+    }
+    CDeterministicMNList curList = GetListForBlock(chainActive[nStartHeight - 1]);
+
+    CDBBatch batch(evoDb.GetRawDB());
+    for (int nHeight = nStartHeight; nHeight <= chainActive.Height(); nHeight++) {
+        auto pindex = chainActive[nHeight];
+
+        CDeterministicMNListDiff diff;
+        if (!evoDb.Read(std::make_pair(DB_LIST_DIFF, pindex->GetBlockHash()), diff)) {
+            curList = CDeterministicMNList(pindex->GetBlockHash(), -1, 0);
+        } else if (diff.HasChanges()) {
+            curList = curList.ApplyDiff(pindex, diff);
+        } else {
+            curList.SetBlockHash(pindex->GetBlockHash());
+            curList.SetHeight(pindex->nHeight);
+        }
+
+        bool fOldSnapshot = (nHeight % nOldInterval) == 0;
+        bool fNewSnapshot = (nHeight % nSnapshotInterval) == 0;
+        if (fNewSnapshot && !fOldSnapshot) {
+            batch.Write(std::make_pair(DB_LIST_SNAPSHOT, pindex->GetBlockHash()), curList);
+        } else if (fOldSnapshot && !fNewSnapshot) {
+            batch.Erase(std::make_pair(DB_LIST_SNAPSHOT, pindex->GetBlockHash()));
+        }
+
+        if (batch.SizeEstimate() > (16 << 20)) {
+            evoDb.GetRawDB().WriteBatch(batch);
+            batch.Clear();
+        }
+    }
+
+    // written last, so that an interrupted migration is done again on the next start
+    batch.Write(DB_SNAPSHOT_INTERVAL, nSnapshotInterval);
+    evoDb.GetRawDB().WriteBatch(batch);
+
+    // cached lists were not touched, but snapshots of the old interval might be cached
+    mnListsCache.clear();
+
+    LogPrintf("CDeterministicMNManager::%s -- done changing snapshot interval\n", __func__);
+}
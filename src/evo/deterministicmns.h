@@ -14,9 +14,13 @@
 #include "simplifiedmns.h"
 #include "sync.h"
 
+#include "ctpl.h"
+
+#include "immer/flex_vector.hpp"
 #include "immer/map.hpp"
 #include "immer/map_transient.hpp"
 
+#include <list>
 #include <map>
 
 class CBlock;
@@ -276,6 +280,8 @@ public:
     typedef immer::map<uint256, CDeterministicMNCPtr> MnMap;
     typedef immer::map<uint64_t, uint256> MnInternalIdMap;
     typedef immer::map<uint256, std::pair<uint256, uint32_t> > MnUniquePropertyMap;
+    typedef std::pair<int, uint256> MnPayeeIndexKey;
+    typedef immer::flex_vector<MnPayeeIndexKey> MnPayeeIndex;
 
 private:
     uint256 blockHash;
@@ -288,6 +294,10 @@ private:
     // we keep track of this as checking for duplicates would otherwise be painfully slow
     MnUniquePropertyMap mnUniquePropertyMap;
 
+    // all valid MNs in the order in which they get paid, keyed by the height used for ordering and the proTxHash
+    // shares structure between list versions like the maps above, so updates and lookups stay logarithmic
+    MnPayeeIndex mnPayeeIndex;
+
 public:
     CDeterministicMNList() {}
     explicit CDeterministicMNList(const uint256& _blockHash, int _height, uint32_t _totalRegisteredCount) :
@@ -321,6 +331,7 @@ public:
         mnMap = MnMap();
         mnUniquePropertyMap = MnUniquePropertyMap();
         mnInternalIdMap = MnInternalIdMap();
+        mnPayeeIndex = MnPayeeIndex();
 
         SerializationOpBase(s, CSerActionUnserialize());
 
@@ -338,13 +349,7 @@ public:
 
     size_t GetValidMNsCount() const
     {
-        size_t count = 0;
-        for (const auto& p : mnMap) {
-            if (IsMNValid(p.second)) {
-                count++;
-            }
-        }
-        return count;
+        return mnPayeeIndex.size();
     }
 
     template <typename Callback>
@@ -531,6 +536,11 @@ private:
             AddUniqueProperty(dmn, newValue);
         }
     }
+
+    // position of the first entry in mnPayeeIndex which is not less than key
+    size_t LowerBoundPayeeIndex(const MnPayeeIndexKey& key) const;
+    void AddToPayeeIndex(const CDeterministicMNCPtr& dmn);
+    void RemoveFromPayeeIndex(const CDeterministicMNCPtr& dmn);
 };
 
 class CDeterministicMNListDiff
@@ -618,10 +628,17 @@ public:
     }
 };
 
+/** -dmnsnapshotinterval default, a full list is written every that many blocks and diffs in-between */
+static const int DEFAULT_DMN_SNAPSHOT_INTERVAL = 576; // once per day
+/** -dmnlistcache default in MiB, for lists which are older than the pinned recent lists */
+static const int64_t DEFAULT_DMN_LIST_CACHE_SIZE = 64;
+
 class CDeterministicMNManager
 {
-    static const int SNAPSHOT_LIST_PERIOD = 576; // once per day
+    // lists of the most recent blocks are pinned in mnListsCache
     static const int LISTS_CACHE_SIZE = 576;
+    // assumed memory usage of one MN in a list, ignoring what is shared with other lists
+    static const size_t LIST_ENTRY_MEMORY_USAGE = 512;
 
 public:
     CCriticalSection cs;
@@ -629,17 +646,35 @@ public:
 private:
     CEvoDB& evoDb;
 
+    int nSnapshotInterval;
+
     std::map<uint256, CDeterministicMNList> mnListsCache;
     const CBlockIndex* tipIndex{nullptr};
 
+    // LRU of older lists which were requested, e.g. for quorums or historical RPCs, bounded by nHistoricalCacheMaxUsage
+    std::list<uint256> historicalListsOrder;
+    std::map<uint256, std::pair<CDeterministicMNList, std::list<uint256>::iterator>> historicalListsCache;
+    size_t nHistoricalCacheUsage{0};
+    size_t nHistoricalCacheMaxUsage;
+
+    // loads lists of active quorums in the background, so that signing and verification doesn't have to wait for it
+    ctpl::thread_pool warmupPool;
+    int nLastWarmupHeight{-1};
+    bool fWarmupStopped{false};
+
 public:
-    CDeterministicMNManager(CEvoDB& _evoDb);
+    CDeterministicMNManager(CEvoDB& _evoDb, int _nSnapshotInterval = DEFAULT_DMN_SNAPSHOT_INTERVAL, size_t _nHistoricalCacheMaxUsage = DEFAULT_DMN_LIST_CACHE_SIZE << 20);
+    ~CDeterministicMNManager();
 
     bool ProcessBlock(const CBlock& block, const CBlockIndex* pindex, CValidationState& state, bool fJustCheck);
     bool UndoBlock(const CBlock& block, const CBlockIndex* pindex);
 
     void UpdatedBlockTip(const CBlockIndex* pindex);
 
+    // Drops queued warm-ups and waits for the running one. Warm-ups use the block index, so this must be called
+    // before it is unloaded.
+    void StopWarmup();
+
     // the returned list will not contain the correct block hash (we can't know it yet as the coinbase TX is not updated yet)
     bool BuildNewListFromBlock(const CBlock& block, const CBlockIndex* pindexPrev, CValidationState& state, CDeterministicMNList& mnListRet, bool debugLogs);
     void HandleQuorumCommitment(llmq::CFinalCommitment& qc, const CBlockIndex* pindexQuorum, CDeterministicMNList& mnList, bool debugLogs);
@@ -658,8 +693,16 @@ public:
     bool UpgradeDiff(CDBBatch& batch, const CBlockIndex* pindexNext, const CDeterministicMNList& curMNList, CDeterministicMNList& newMNList);
     void UpgradeDBIfNeeded();
 
+    // rewrites snapshots once when -dmnsnapshotinterval differs from the interval the DB was written with
+    void MigrateSnapshotIntervalIfNeeded();
+
 private:
     void CleanupCache(int nHeight);
+
+    bool GetCachedList(const uint256& blockHash, CDeterministicMNList& mnListRet);
+    void AddHistoricalList(const CDeterministicMNList& mnList);
+    void EraseHistoricalList(const uint256& blockHash);
+    void ScheduleWarmup(const CBlockIndex* pindex);
 };
 
 extern CDeterministicMNManager* deterministicMNManager;
@@ -175,8 +175,14 @@ private:
 
     vote_m_t mapCurrentMNVotes;
 
+    /// number of current votes per (signal, outcome), kept in sync with mapCurrentMNVotes
+    std::map<std::pair<int, int>, int> mapVoteTallies;
+
     CGovernanceObjectVoteFile fileVotes;
 
+    void UpdateVoteTally(int nSignal, vote_outcome_enum_t eOutcome, int nDelta);
+    void RebuildVoteTallies();
+
 public:
     CGovernanceObject();
 
@@ -329,6 +335,9 @@ public:
             READWRITE(nDeletionTime);
             READWRITE(fExpired);
             READWRITE(mapCurrentMNVotes);
+            if (ser_action.ForRead()) {
+                RebuildVoteTallies();
+            }
             READWRITE(fileVotes);
             LogPrint(BCLog::GOBJECT, "CGovernanceObject::SerializationOp hash = %s, vote count = %d\n", GetHash().ToString(), fileVotes.GetVoteCount());
         }
@@ -343,7 +352,8 @@ public:
     bool ProcessVote(CNode* pfrom,
         const CGovernanceVote& vote,
         CGovernanceException& exception,
-        CConnman& connman);
+        CConnman& connman,
+        bool fSignatureVerified = false);
 
     /// Called when MN's which have voted on this object have been removed
     void ClearMasternodeVotes();
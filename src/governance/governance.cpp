@@ -3,7 +3,9 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "governance.h"
+#include "bls/bls_batchverifier.h"
 #include "consensus/validation.h"
+#include "cxxtimer.hpp"
 #include "governance-classes.h"
 #include "governance-object.h"
 #include "governance-validators.h"
@@ -234,21 +236,208 @@ void CGovernanceManager::ProcessMessage(CNode* pfrom, const std::string& strComm
             return;
         }
 
-        CGovernanceException exception;
-        if (ProcessVote(pfrom, vote, exception, connman)) {
-            LogPrint(BCLog::GOBJECT, "MNGOVERNANCEOBJECTVOTE -- %s new\n", strHash);
-            masternodeSync.BumpAssetLastTime("MNGOVERNANCEOBJECTVOTE");
-            vote.Relay(connman);
+        // Votes for objects we already have are verified in batches by ProcessPendingVotes,
+        // orphan votes still go through ProcessVote right away so that the parent gets requested
+        bool fQueued = false;
+        std::map<NodeId, std::vector<CGovernanceVote>> mapVotesToVerify;
+        {
+            LOCK(cs);
+            if (mapObjects.count(vote.GetParentHash())) {
+                auto& vecVotes = mapPendingVotes[pfrom->GetId()];
+                vecVotes.emplace_back(vote);
+                fQueued = true;
+                if (vecVotes.size() >= MAX_PENDING_VOTES_PER_NODE) {
+                    // only this peer's queue is verified right away, the others are left to the scheduler
+                    mapVotesToVerify[pfrom->GetId()].swap(vecVotes);
+                    mapPendingVotes.erase(pfrom->GetId());
+                }
+            }
+        }
+
+        if (!fQueued) {
+            ProcessPeerVote(pfrom->GetId(), pfrom, vote, false, connman);
+        } else if (!mapVotesToVerify.empty()) {
+            VerifyAndProcessVotes(mapVotesToVerify, connman);
+        }
+    }
+}
+
+void CGovernanceManager::ProcessPeerVote(NodeId nodeId, CNode* pfrom, const CGovernanceVote& vote, bool fSignatureVerified, CConnman& connman)
+{
+    CGovernanceException exception;
+    if (ProcessVote(pfrom, vote, exception, connman, fSignatureVerified)) {
+        LogPrint(BCLog::GOBJECT, "MNGOVERNANCEOBJECTVOTE -- %s new\n", vote.GetHash().ToString());
+        masternodeSync.BumpAssetLastTime("MNGOVERNANCEOBJECTVOTE");
+        vote.Relay(connman);
+    } else {
+        LogPrint(BCLog::GOBJECT, "MNGOVERNANCEOBJECTVOTE -- Rejected vote, error = %s\n", exception.what());
+        if ((exception.GetNodePenalty() != 0) && masternodeSync.IsSynced()) {
+            LOCK(cs_main);
+            Misbehaving(nodeId, exception.GetNodePenalty());
+        }
+        return;
+    }
+    // SEND NOTIFICATION TO SCRIPT/ZMQ
+    GetMainSignals().NotifyGovernanceVote(vote);
+}
+
+void CGovernanceManager::StartVoteVerification()
+{
+    int nThreads = std::max(1, std::min(GetNumCores(), MAX_VOTE_VERIFICATION_THREADS));
+    voteVerificationPool.resize(nThreads);
+    RenameThreadPool(voteVerificationPool, "ion-gov-verify");
+}
+
+void CGovernanceManager::StopVoteVerification()
+{
+    voteVerificationPool.clear_queue();
+    voteVerificationPool.stop(true);
+}
+
+void CGovernanceManager::ProcessPendingVotes(CConnman& connman)
+{
+    std::map<NodeId, std::vector<CGovernanceVote>> mapVotes;
+    {
+        LOCK(cs);
+        mapVotes.swap(mapPendingVotes);
+    }
+    VerifyAndProcessVotes(mapVotes, connman);
+}
+
+void CGovernanceManager::VerifyAndProcessVotes(const std::map<NodeId, std::vector<CGovernanceVote>>& mapVotes, CConnman& connman)
+{
+    if (mapVotes.empty()) {
+        return;
+    }
+
+    enum SignatureCheck {
+        SIGCHECK_NONE,      // left to ProcessVote, e.g. known votes or unknown masternodes
+        SIGCHECK_VOTINGKEY, // ECDSA, checked on voteVerificationPool
+        SIGCHECK_OPERATORKEY // BLS, checked in a batch
+    };
+    struct PendingVote {
+        NodeId nodeId;
+        const CGovernanceVote* pvote;
+        SignatureCheck check;
+        CKeyID keyIDVoting;
+        char fValid;
+    };
+
+    // Signatures are checked against the keys of the list at the tip, same as CGovernanceVote::IsValid does
+    auto mnList = deterministicMNManager->GetListAtChainTip();
+
+    std::vector<PendingVote> vecVotes;
+    std::vector<size_t> vecVotingKeyVotes;
+    {
+        LOCK(cs);
+        for (const auto& p : mapVotes) {
+            for (const auto& vote : p.second) {
+                PendingVote pendingVote{p.first, &vote, SIGCHECK_NONE, CKeyID(), 0};
+                uint256 nHashVote = vote.GetHash();
+                object_m_cit it = mapObjects.find(vote.GetParentHash());
+                auto dmn = mnList.GetMNByCollateral(vote.GetMasternodeOutpoint());
+                if (it != mapObjects.end() && dmn && !cmapVoteToObject.HasKey(nHashVote) && !cmapInvalidVotes.HasKey(nHashVote)) {
+                    if (it->second.GetObjectType() == GOVERNANCE_OBJECT_PROPOSAL && vote.GetSignal() == VOTE_SIGNAL_FUNDING) {
+                        pendingVote.check = SIGCHECK_VOTINGKEY;
+                        pendingVote.keyIDVoting = dmn->pdmnState->keyIDVoting;
+                        vecVotingKeyVotes.emplace_back(vecVotes.size());
+                    } else {
+                        pendingVote.check = SIGCHECK_OPERATORKEY;
+                    }
+                }
+                vecVotes.emplace_back(pendingVote);
+            }
+        }
+    }
+
+    cxxtimer::Timer verifyTimer(true);
+
+    // ECDSA signatures can't be aggregated, spread them over the worker threads while the BLS batch is verified here
+    std::vector<std::future<void>> futures;
+    int nJobs = std::max(1, (int)voteVerificationPool.size());
+    for (int nJob = 0; nJob < nJobs && !vecVotingKeyVotes.empty(); nJob++) {
+        auto verifyJob = [&, nJob](int threadId) {
+            for (size_t i = nJob; i < vecVotingKeyVotes.size(); i += nJobs) {
+                auto& pendingVote = vecVotes[vecVotingKeyVotes[i]];
+                pendingVote.fValid = pendingVote.pvote->CheckSignature(pendingVote.keyIDVoting);
+            }
+        };
+        if (voteVerificationPool.size() == 0) {
+            verifyJob(0);
         } else {
-            LogPrint(BCLog::GOBJECT, "MNGOVERNANCEOBJECTVOTE -- Rejected vote, error = %s\n", exception.what());
-            if ((exception.GetNodePenalty() != 0) && masternodeSync.IsSynced()) {
-                LOCK(cs_main);
-                Misbehaving(pfrom->GetId(), exception.GetNodePenalty());
+            futures.emplace_back(voteVerificationPool.push(verifyJob));
+        }
+    }
+
+    // Operator keys are chosen by the masternode owners, so the secure form is needed to avoid the rogue public key
+    // attack. Messages are identified by their index as a peer could send a known vote with a different signature.
+    CBLSBatchVerifier<NodeId, size_t> batchVerifier(true, true);
+    for (size_t i = 0; i < vecVotes.size(); i++) {
+        auto& pendingVote = vecVotes[i];
+        if (pendingVote.check != SIGCHECK_OPERATORKEY) {
+            continue;
+        }
+        auto dmn = mnList.GetMNByCollateral(pendingVote.pvote->GetMasternodeOutpoint());
+        CBLSPublicKey pubKey = dmn->pdmnState->pubKeyOperator.Get();
+        CBLSSignature sig;
+        sig.SetBuf(pendingVote.pvote->GetSignature());
+        if (!sig.IsValid() || !pubKey.IsValid()) {
+            batchVerifier.badSources.emplace(pendingVote.nodeId);
+            batchVerifier.badMessages.emplace(i);
+            continue;
+        }
+        batchVerifier.PushMessage(pendingVote.nodeId, i, pendingVote.pvote->GetSignatureHash(), sig, pubKey);
+    }
+    batchVerifier.Verify();
+    for (size_t i = 0; i < vecVotes.size(); i++) {
+        if (vecVotes[i].check == SIGCHECK_OPERATORKEY) {
+            vecVotes[i].fValid = !batchVerifier.badMessages.count(i);
+        }
+    }
+
+    for (auto& f : futures) {
+        f.get();
+    }
+    verifyTimer.stop();
+
+    LogPrint(BCLog::GOBJECT, "CGovernanceManager::%s -- verified vote signatures. votes=%d, ecdsa=%d, nodes=%d, bad nodes=%d, vt=%d\n", __func__,
+        vecVotes.size(), vecVotingKeyVotes.size(), mapVotes.size(), batchVerifier.badSources.size(), verifyTimer.count());
+
+    // Valid votes go first, a copy of the same vote with a bad signature from another peer must not get it marked as
+    // invalid. Peers are only punished for bad copies of votes that no other peer sent with a valid signature.
+    std::set<uint256> setValidVotes;
+    for (const auto& pendingVote : vecVotes) {
+        if (pendingVote.check == SIGCHECK_NONE) {
+            ProcessPeerVote(pendingVote.nodeId, nullptr, *pendingVote.pvote, false, connman);
+        } else if (pendingVote.fValid) {
+            setValidVotes.emplace(pendingVote.pvote->GetHash());
+            ProcessPeerVote(pendingVote.nodeId, nullptr, *pendingVote.pvote, true, connman);
+        }
+    }
+
+    for (const auto& pendingVote : vecVotes) {
+        if (pendingVote.check == SIGCHECK_NONE || pendingVote.fValid) {
+            continue;
+        }
+        const CGovernanceVote& vote = *pendingVote.pvote;
+        uint256 nHashVote = vote.GetHash();
+        if (setValidVotes.count(nHashVote)) {
+            continue;
+        }
+        {
+            LOCK(cs);
+            if (cmapVoteToObject.HasKey(nHashVote)) {
+                // known from an earlier batch, ignore it like ProcessVote would
+                continue;
             }
-            return;
+            AddInvalidVote(vote);
+        }
+        LogPrintf("CGovernanceManager::%s -- Invalid vote signature, MN outpoint = %s, governance object hash = %s, vote hash = %s, peer=%d\n", __func__,
+            vote.GetMasternodeOutpoint().ToStringShort(), vote.GetParentHash().ToString(), nHashVote.ToString(), pendingVote.nodeId);
+        if (masternodeSync.IsSynced()) {
+            LOCK(cs_main);
+            Misbehaving(pendingVote.nodeId, 20);
         }
-        // SEND NOTIFICATION TO SCRIPT/ZMQ
-        GetMainSignals().NotifyGovernanceVote(vote);
     }
 }
 
@@ -789,7 +978,7 @@ bool CGovernanceManager::MasternodeRateCheck(const CGovernanceObject& govobj, bo
     return false;
 }
 
-bool CGovernanceManager::ProcessVote(CNode* pfrom, const CGovernanceVote& vote, CGovernanceException& exception, CConnman& connman)
+bool CGovernanceManager::ProcessVote(CNode* pfrom, const CGovernanceVote& vote, CGovernanceException& exception, CConnman& connman, bool fSignatureVerified)
 {
     ENTER_CRITICAL_SECTION(cs);
     uint256 nHashVote = vote.GetHash();
@@ -838,7 +1027,7 @@ bool CGovernanceManager::ProcessVote(CNode* pfrom, const CGovernanceVote& vote,
         return false;
     }
 
-    bool fOk = govobj.ProcessVote(pfrom, vote, exception, connman) && cmapVoteToObject.Insert(nHashVote, &govobj);
+    bool fOk = govobj.ProcessVote(pfrom, vote, exception, connman, fSignatureVerified) && cmapVoteToObject.Insert(nHashVote, &govobj);
     LEAVE_CRITICAL_SECTION(cs);
     return fOk;
 }
@@ -9,6 +9,7 @@
 #include "cachemap.h"
 #include "cachemultimap.h"
 #include "chain.h"
+#include "ctpl.h"
 #include "governance-exceptions.h"
 #include "governance-object.h"
 #include "governance-vote.h"
@@ -28,6 +29,11 @@ class CGovernanceVote;
 
 extern CGovernanceManager governance;
 
+namespace governance_votes_tests
+{
+    class TestGovernanceManager;
+}
+
 struct ExpirationInfo {
     ExpirationInfo(int64_t _nExpirationTime, int _idFrom) :
         nExpirationTime(_nExpirationTime), idFrom(_idFrom) {}
@@ -151,6 +157,7 @@ public:
 class CGovernanceManager
 {
     friend class CGovernanceObject;
+    friend class governance_votes_tests::TestGovernanceManager; // for test access to the pending votes and caches
 
 public: // Types
     struct last_object_rec {
@@ -220,6 +227,10 @@ private:
     static const int MAX_TIME_FUTURE_DEVIATION;
     static const int RELIABLE_PROPAGATION_TIME;
 
+    // the queued votes of a single peer are verified right away when this many are pending
+    static const size_t MAX_PENDING_VOTES_PER_NODE = 1000;
+    static const int MAX_VOTE_VERIFICATION_THREADS = 8;
+
     int64_t nTimeLastDiff;
 
     // keep track of current block height
@@ -250,6 +261,12 @@ private:
 
     bool fRateChecksEnabled;
 
+    // votes with a known parent object waiting for batched signature verification
+    std::map<NodeId, std::vector<CGovernanceVote>> mapPendingVotes;
+
+    // ECDSA vote signatures are checked on these threads
+    ctpl::thread_pool voteVerificationPool;
+
     // used to check for changed voting keys
     CDeterministicMNList lastMNListForVotingKeys;
 
@@ -295,6 +312,12 @@ public:
 
     void DoMaintenance(CConnman& connman);
 
+    void StartVoteVerification();
+    void StopVoteVerification();
+
+    /// Verifies the signatures of all queued votes in batches and processes the valid ones
+    void ProcessPendingVotes(CConnman& connman);
+
     CGovernanceObject* FindGovernanceObject(const uint256& nHash);
 
     // These commands are only used in RPC
@@ -318,6 +341,7 @@ public:
         cmapInvalidVotes.Clear();
         cmmapOrphanVotes.Clear();
         mapLastMasternodeObject.clear();
+        mapPendingVotes.clear();
     }
 
     std::string ToString() const;
@@ -408,7 +432,13 @@ private:
         cmapInvalidVotes.Insert(vote.GetHash(), vote);
     }
 
-    bool ProcessVote(CNode* pfrom, const CGovernanceVote& vote, CGovernanceException& exception, CConnman& connman);
+    bool ProcessVote(CNode* pfrom, const CGovernanceVote& vote, CGovernanceException& exception, CConnman& connman, bool fSignatureVerified = false);
+
+    /// Verifies the signatures of the given votes in batches and processes them
+    void VerifyAndProcessVotes(const std::map<NodeId, std::vector<CGovernanceVote>>& mapVotes, CConnman& connman);
+
+    /// Processes a vote received from a peer and relays it or punishes the peer
+    void ProcessPeerVote(NodeId nodeId, CNode* pfrom, const CGovernanceVote& vote, bool fSignatureVerified, CConnman& connman);
 
     /// Called to indicate a requested object has been received
     bool AcceptObjectMessage(const uint256& nHash);
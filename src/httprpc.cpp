@@ -7,6 +7,7 @@
 #include "base58.h"
 #include "chainparams.h"
 #include "httpserver.h"
+#include "rpc/jsonwriter.h"
 #include "rpc/protocol.h"
 #include "rpc/server.h"
 #include "random.h"
@@ -185,7 +186,37 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         if (valRequest.isObject()) {
             jreq.parse(valRequest);
 
-            UniValue result = tableRPC.execute(jreq);
+            // Large results are sent in chunks as they are written, the reply is started with the first one
+            bool fReplyStarted = false;
+            CJSONWriter writer([req, &fReplyStarted](const std::string& strChunk) {
+                if (!fReplyStarted) {
+                    req->WriteHeader("Content-Type", "application/json");
+                    req->StartReplyChunked(HTTP_OK);
+                    req->WriteReplyChunk("{\"result\":");
+                    fReplyStarted = true;
+                }
+                return req->WriteReplyChunk(strChunk);
+            });
+            jreq.resultWriter = &writer;
+
+            UniValue result;
+            try {
+                result = tableRPC.execute(jreq);
+            } catch (...) {
+                if (!fReplyStarted)
+                    throw;
+                // The status was already sent, cut the reply short so that the client fails to parse it
+                LogPrintf("%s: %s failed after part of its result was sent\n", __func__, jreq.strMethod);
+                req->EndReplyChunked();
+                return false;
+            }
+
+            if (!writer.IsEmpty()) {
+                writer.Flush();
+                req->WriteReplyChunk(",\"error\":null,\"id\":" + jreq.id.write() + "}\n");
+                req->EndReplyChunked();
+                return true;
+            }
 
             // Send reply
             strReply = JSONRPCReply(result, NullUniValue, jreq.id);
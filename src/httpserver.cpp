@@ -515,11 +515,16 @@ void HTTPEvent::trigger(struct timeval* tv)
         evtimer_add(ev, tv); // trigger after timeval passed
 }
 HTTPRequest::HTTPRequest(struct evhttp_request* _req) : req(_req),
-                                                       replySent(false)
+                                                       replySent(false),
+                                                       chunkedReplyOpen(false)
 {
 }
 HTTPRequest::~HTTPRequest()
 {
+    if (chunkedReplyOpen) {
+        LogPrintf("%s: Unfinished chunked reply\n", __func__);
+        EndReplyChunked();
+    }
     if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
@@ -566,6 +571,22 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
     evhttp_add_header(headers, hdr.c_str(), value.c_str());
 }
 
+/** Re-enable reading from the socket once the reply was sent. This is the second
+ * part of the libevent workaround above.
+ */
+static void reenable_http_read(struct evhttp_request* req)
+{
+    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
+        evhttp_connection* conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 /** Closure sent to main thread to request a reply to be sent to
  * a HTTP request.
  * Replies must be sent in the main loop in the main http thread,
@@ -584,23 +605,137 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
     auto req_copy = req;
     HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
-        // Re-enable reading from the socket. This is the second part of the libevent
-        // workaround above.
-        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
-            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
-            if (conn) {
-                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
-            }
-        }
+        reenable_http_read(req_copy);
     });
     ev->trigger(0);
     replySent = true;
     req = 0; // transferred back to main thread
 }
 
+/** Flow control of a chunked reply, shared between the worker producing it and the main http thread */
+struct HTTPChunkedReplyState
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    // bytes of chunks waiting for their event in the main http thread
+    size_t nQueued{0};
+    // bytes handed to libevent that were not written to the socket yet
+    size_t nBuffered{0};
+    // the connection was closed, further chunks are dropped
+    bool fClosed{false};
+};
+
+/** Called by libevent once the connection's output buffer was drained */
+static void http_reply_chunk_sent_cb(struct evhttp_connection* conn, void* arg)
+{
+    HTTPChunkedReplyState* state = (HTTPChunkedReplyState*)arg;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->nBuffered = 0;
+    }
+    state->cond.notify_all();
+}
+
+static void http_reply_chunked_close_cb(struct evhttp_connection* conn, void* arg)
+{
+    HTTPChunkedReplyState* state = (HTTPChunkedReplyState*)arg;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->fClosed = true;
+    }
+    state->cond.notify_all();
+}
+
+/** Chunked replies are sent by the main http thread as well. Each chunk is
+ * queued as its own event, libevent runs them in the order they were triggered.
+ */
+void HTTPRequest::StartReplyChunked(int nStatus)
+{
+    assert(!replySent && req);
+    if (ShutdownRequested()) {
+        WriteHeader("Connection", "close");
+    }
+    chunkedReplyState = std::make_shared<HTTPChunkedReplyState>();
+    auto req_copy = req;
+    auto state = chunkedReplyState;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus, state]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (conn) {
+            // reset again by EndReplyChunked, the state must not be used after the reply ended
+            evhttp_connection_set_closecb(conn, http_reply_chunked_close_cb, state.get());
+        } else {
+            http_reply_chunked_close_cb(nullptr, state.get());
+        }
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+    });
+    ev->trigger(0);
+    replySent = true;
+    chunkedReplyOpen = true;
+}
+
+bool HTTPRequest::WriteReplyChunk(const std::string& strChunk)
+{
+    assert(chunkedReplyOpen);
+    auto state = chunkedReplyState;
+    {
+        // Wait for the client to catch up, so that a slow client can't make the whole reply pile up in memory
+        std::unique_lock<std::mutex> lock(state->mutex);
+        while (!state->fClosed && state->nQueued + state->nBuffered >= MAX_CHUNKED_REPLY_UNSENT && !ShutdownRequested()) {
+            state->cond.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        if (state->fClosed) {
+            return false;
+        }
+        state->nQueued += strChunk.size();
+    }
+
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add(evb, strChunk.data(), strChunk.size());
+    auto req_copy = req;
+    size_t nSize = strChunk.size();
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, evb, state, nSize]{
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->nQueued -= nSize;
+#if LIBEVENT_VERSION_NUMBER >= 0x02010100
+            if (!state->fClosed) {
+                state->nBuffered += nSize;
+            }
+#endif
+        }
+#if LIBEVENT_VERSION_NUMBER >= 0x02010100
+        evhttp_send_reply_chunk_with_cb(req_copy, evb, http_reply_chunk_sent_cb, state.get());
+#else
+        evhttp_send_reply_chunk(req_copy, evb);
+#endif
+        evbuffer_free(evb);
+        state->cond.notify_all();
+    });
+    ev->trigger(0);
+    return true;
+}
+
+void HTTPRequest::EndReplyChunked()
+{
+    assert(chunkedReplyOpen);
+    auto req_copy = req;
+    auto state = chunkedReplyState;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, state]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (conn) {
+            evhttp_connection_set_closecb(conn, nullptr, nullptr);
+        }
+        // replaces the chunk sent callback, which points to the state as well
+        evhttp_send_reply_end(req_copy);
+        reenable_http_read(req_copy);
+    });
+    ev->trigger(0);
+    chunkedReplyOpen = false;
+    chunkedReplyState.reset();
+    req = nullptr;
+}
+
 CService HTTPRequest::GetPeer()
 {
     evhttp_connection* con = evhttp_request_get_connection(req);
@@ -8,15 +8,19 @@
 #include <string>
 #include <stdint.h>
 #include <functional>
+#include <memory>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
+/** Maximum bytes of a chunked reply that may wait to be sent to the client before WriteReplyChunk blocks */
+static const size_t MAX_CHUNKED_REPLY_UNSENT = 1 << 20;
 
 struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
+struct HTTPChunkedReplyState;
 
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
@@ -59,6 +63,8 @@ class HTTPRequest
 private:
     struct evhttp_request* req;
     bool replySent;
+    bool chunkedReplyOpen;
+    std::shared_ptr<HTTPChunkedReplyState> chunkedReplyState;
 
 public:
     HTTPRequest(struct evhttp_request* req);
@@ -114,6 +120,18 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Start a chunked HTTP reply, for bodies that are produced incrementally.
+     * The body is sent with WriteReplyChunk and the reply completed by EndReplyChunked.
+     * WriteReplyChunk blocks while too much of the reply wasn't sent to the client yet, and
+     * returns false once the client closed the connection. EndReplyChunked must still be called.
+     *
+     * @note Like WriteReply, call this only once and after writing the headers.
+     */
+    void StartReplyChunked(int nStatus);
+    bool WriteReplyChunk(const std::string& strChunk);
+    void EndReplyChunked();
 };
 
 /** Event handler closure.
@@ -26,6 +26,10 @@ ZerocoinParams::ZerocoinParams(CBigNum N, uint32_t securityLevel) {
     // Generate the parameters
     CalculateParams(*this, N, ZEROCOIN_PROTOCOL_VERSION, securityLevel);
 
+    // Serial number proofs raise the generators of both groups to many exponents
+    this->coinCommitmentGroup.BuildFixedBaseTables();
+    this->serialNumberSoKCommitmentGroup.BuildFixedBaseTables();
+
     this->accumulatorParams.initialized = true;
     this->initialized = true;
 }
@@ -38,6 +42,29 @@ IntegerGroupParams::IntegerGroupParams() {
     this->initialized = false;
 }
 
+void IntegerGroupParams::BuildFixedBaseTables() {
+    this->gTable = std::make_shared<const CBigNumFixedBase>(this->g, this->groupOrder, this->modulus);
+    this->hTable = std::make_shared<const CBigNumFixedBase>(this->h, this->groupOrder, this->modulus);
+}
+
+CBigNum IntegerGroupParams::pow_g(const CBigNum& e) const {
+    if (!this->gTable)
+        return this->g.pow_mod(e, this->modulus);
+    return this->gTable->pow_mod(e);
+}
+
+CBigNum IntegerGroupParams::pow_h(const CBigNum& e) const {
+    if (!this->hTable)
+        return this->h.pow_mod(e, this->modulus);
+    return this->hTable->pow_mod(e);
+}
+
+CBigNum IntegerGroupParams::pow_gh(const CBigNum& e1, const CBigNum& e2) const {
+    if (!this->gTable || !this->hTable)
+        return this->g.pow_mod(e1, this->modulus).mul_mod(this->h.pow_mod(e2, this->modulus), this->modulus);
+    return this->gTable->mul_pow_mod(e1, *this->hTable, e2);
+}
+
 CBigNum IntegerGroupParams::randomElement() const {
     // The generator of the group raised
     // to a random number less than the order of the group
@@ -17,6 +17,8 @@
 #include "bignum.h"
 #include "ZerocoinDefines.h"
 
+#include <memory>
+
 namespace libzerocoin {
 
 class IntegerGroupParams {
@@ -56,6 +58,25 @@ public:
 	 */
 	CBigNum groupOrder;
 
+	/**
+	 * Precomputed powers of g and h, shared between copies.
+	 * Built by ZerocoinParams and not serialized, without them
+	 * the methods below fall back to plain pow_mod.
+	 */
+	std::shared_ptr<const CBigNumFixedBase> gTable;
+	std::shared_ptr<const CBigNumFixedBase> hTable;
+
+	void BuildFixedBaseTables();
+
+	/**
+	 * Exponentiations of the generators for proof verification.
+	 * Exponents must be public, see CBigNumFixedBase.
+	 * @return g^e mod modulus, h^e mod modulus and g^e1 * h^e2 mod modulus
+	 */
+	CBigNum pow_g(const CBigNum& e) const;
+	CBigNum pow_h(const CBigNum& e) const;
+	CBigNum pow_gh(const CBigNum& e1, const CBigNum& e2) const;
+
 	ADD_SERIALIZE_METHODS;
 
     template <typename Stream, typename Operation>
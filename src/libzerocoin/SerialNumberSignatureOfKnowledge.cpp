@@ -13,11 +13,25 @@
 
 #include <streams.h>
 #include "SerialNumberSignatureOfKnowledge.h"
+#include "ctpl.h"
+#include "util.h"
+
+#include <atomic>
+#include <future>
 
 namespace libzerocoin {
 
 SerialNumberSignatureOfKnowledge::SerialNumberSignatureOfKnowledge(const ZerocoinParams* p): params(p) { }
 
+// Shared by all verifications, so that concurrent verifications queue up instead of each starting their own threads
+static ctpl::thread_pool& GetVerifyPool()
+{
+    static ctpl::thread_pool pool(std::max(0, std::min(GetNumCores(), SOK_MAX_VERIFY_THREADS) - 1));
+    static bool fRenamed = (RenameThreadPool(pool, "ion-sok-verify"), true);
+    (void)fRenamed;
+    return pool;
+}
+
 // Use one 256 bit seed and concatenate 4 unique 256 bit hashes to make a 1024 bit hash
 CBigNum SeedTo1024(arith_uint256 hashSeed) {
     CHashWriter hasher(0,0);
@@ -122,13 +136,17 @@ inline CBigNum SerialNumberSignatureOfKnowledge::challengeCalculation(const CBig
     return (g.pow_mod(exponent, params->serialNumberSoKCommitmentGroup.modulus) * h.pow_mod(h_exp, params->serialNumberSoKCommitmentGroup.modulus)) % params->serialNumberSoKCommitmentGroup.modulus;
 }
 
+inline CBigNum SerialNumberSignatureOfKnowledge::challengeCalculationPublic(const CBigNum& a_exp,const CBigNum& b_exp,
+        const CBigNum& h_exp) const {
+
+    // a and b are the generators of coinCommitmentGroup, whose modulus is the order of serialNumberSoKCommitmentGroup
+    CBigNum exponent = params->coinCommitmentGroup.pow_gh(a_exp, b_exp);
+
+    return params->serialNumberSoKCommitmentGroup.pow_gh(exponent, h_exp);
+}
+
 bool SerialNumberSignatureOfKnowledge::Verify(const CBigNum& coinSerialNumber, const CBigNum& valueOfCommitmentToCoin,
         const uint256 msghash, bool isInParamsValidationRange) const {
-    CBigNum a = params->coinCommitmentGroup.g;
-    CBigNum b = params->coinCommitmentGroup.h;
-    CBigNum g = params->serialNumberSoKCommitmentGroup.g;
-    CBigNum h = params->serialNumberSoKCommitmentGroup.h;
-
     //// Params validation.
     if(isInParamsValidationRange) {
         // Check that the serial is within the max size
@@ -141,38 +159,88 @@ bool SerialNumberSignatureOfKnowledge::Verify(const CBigNum& coinSerialNumber, c
     }
 
     //// Verification
+    if (params->coinCommitmentGroup.modulus != params->serialNumberSoKCommitmentGroup.groupOrder)
+        return error("SoK Verify() :: Groups are not structured correctly.");
+
     CHashWriter hasher(0,0);
     hasher << *params << valueOfCommitmentToCoin << coinSerialNumber << msghash;
 
+    if (s_notprime.size() < params->zkp_iterations || sprime.size() < params->zkp_iterations)
+        return error("SoK Verify() :: missing challenge responses");
+
     std::vector<CBigNum> tprime(params->zkp_iterations);
-    unsigned char *hashbytes = (unsigned char*) &this->hash;
-
-    try {
-        for (uint32_t i = 0; i < params->zkp_iterations; i++) {
-            int bit = i % 8;
-            int byte = i / 8;
-            bool challenge_bit = ((hashbytes[byte] >> bit) & 0x01);
-            if (challenge_bit) {
-                CBigNum bn = SeedTo1024(sprime[i].getuint256());
-                if (bn > params->serialNumberSoKCommitmentGroup.groupOrder && isInParamsValidationRange)
-                    return error("SoK Verify() :: sprime in pos %d not in valid range", i);
-                tprime[i] = challengeCalculation(coinSerialNumber, s_notprime[i], bn);
-            } else {
-                CBigNum exp = b.pow_mod(s_notprime[i], params->serialNumberSoKCommitmentGroup.groupOrder);
-                tprime[i] = ((valueOfCommitmentToCoin.pow_mod(exp, params->serialNumberSoKCommitmentGroup.modulus) %
-                              params->serialNumberSoKCommitmentGroup.modulus) *
-                             (h.pow_mod(sprime[i], params->serialNumberSoKCommitmentGroup.modulus) %
-                              params->serialNumberSoKCommitmentGroup.modulus)) %
-                            params->serialNumberSoKCommitmentGroup.modulus;
+    const unsigned char *hashbytes = (const unsigned char*) &this->hash;
+    std::atomic<bool> fInvalid(false);
+
+    // The iterations are independent until their results are hashed, so ranges of them
+    // are computed on separate threads
+    auto verifyIterations = [&](uint32_t nBegin, uint32_t nEnd) {
+        try {
+            for (uint32_t i = nBegin; i < nEnd && !fInvalid; i++) {
+                int bit = i % 8;
+                int byte = i / 8;
+                bool challenge_bit = ((hashbytes[byte] >> bit) & 0x01);
+                if (challenge_bit) {
+                    CBigNum bn = SeedTo1024(sprime[i].getuint256());
+                    if (bn > params->serialNumberSoKCommitmentGroup.groupOrder && isInParamsValidationRange) {
+                        fInvalid = true;
+                        error("SoK Verify() :: sprime in pos %d not in valid range", i);
+                        return;
+                    }
+                    tprime[i] = challengeCalculationPublic(coinSerialNumber, s_notprime[i], bn);
+                } else {
+                    CBigNum exp = params->coinCommitmentGroup.pow_h(s_notprime[i]);
+                    tprime[i] = valueOfCommitmentToCoin.pow_mod(exp, params->serialNumberSoKCommitmentGroup.modulus).mul_mod(
+                                params->serialNumberSoKCommitmentGroup.pow_h(sprime[i]),
+                                params->serialNumberSoKCommitmentGroup.modulus);
+                }
             }
+        } catch (const std::range_error& e) {
+            fInvalid = true;
+            error("SoK Verify() :: sprime invalid range.");
+        } catch (const std::exception& e) {
+            fInvalid = true;
+            error("SoK Verify() :: %s", e.what());
         }
-        for (uint32_t i = 0; i < params->zkp_iterations; i++) {
-            hasher << tprime[i];
+    };
+
+    // Waits for the ranges handed to the pool even if this thread throws, as they reference the locals above
+    struct FuturesGuard {
+        std::vector<std::future<void>> futures;
+        ~FuturesGuard()
+        {
+            for (auto& f : futures) {
+                if (f.valid())
+                    f.wait();
+            }
         }
-        return hasher.GetHash() == hash;
-    } catch (const std::range_error& e) {
-        return error("SoK Verify() :: sprime invalid range.");
+    } guard;
+
+    ctpl::thread_pool& pool = GetVerifyPool();
+    const uint32_t nIterations = params->zkp_iterations;
+    uint32_t nThreads = (uint32_t)pool.size() + 1;
+    nThreads = std::min(nThreads, (nIterations + SOK_MIN_ITERATIONS_PER_THREAD - 1) / SOK_MIN_ITERATIONS_PER_THREAD);
+    nThreads = std::max(nThreads, 1u);
+
+    const uint32_t nPerThread = (nIterations + nThreads - 1) / nThreads;
+    for (uint32_t nBegin = nPerThread; nBegin < nIterations; nBegin += nPerThread) {
+        const uint32_t nEnd = std::min(nBegin + nPerThread, nIterations);
+        guard.futures.emplace_back(pool.push([&verifyIterations, nBegin, nEnd](int threadId) {
+            verifyIterations(nBegin, nEnd);
+        }));
+    }
+    verifyIterations(0, std::min(nPerThread, nIterations));
+    for (auto& f : guard.futures) {
+        f.wait();
+    }
+
+    if (fInvalid)
+        return false;
+
+    for (uint32_t i = 0; i < nIterations; i++) {
+        hasher << tprime[i];
     }
+    return hasher.GetHash() == hash;
 }
 
 } /* namespace libzerocoin */
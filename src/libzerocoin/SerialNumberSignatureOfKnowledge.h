@@ -27,6 +27,11 @@
 
 namespace libzerocoin {
 
+/** Verification splits the zkp_iterations rounds of a proof across threads, with at least this many rounds each */
+static const uint32_t SOK_MIN_ITERATIONS_PER_THREAD = 8;
+/** Threads of the pool shared by all proof verifications, including the verifying thread itself */
+static const int SOK_MAX_VERIFY_THREADS = 8;
+
 /**A Signature of knowledge on the hash of metadata attesting that the signer knows the values
  *  necessary to open a commitment which contains a coin(which it self is of course a commitment)
  * with a given serial number.
@@ -70,6 +75,9 @@ private:
     std::vector<CBigNum> sprime;
     inline CBigNum challengeCalculation(const CBigNum& a_exp, const CBigNum& b_exp,
                                        const CBigNum& h_exp) const;
+    // Same as challengeCalculation, using the precomputed generator tables. Only for public exponents
+    inline CBigNum challengeCalculationPublic(const CBigNum& a_exp, const CBigNum& b_exp,
+                                       const CBigNum& h_exp) const;
 };
 
 } /* namespace libzerocoin */
@@ -209,6 +209,50 @@ public:
     friend inline bool operator>=(const CBigNum& a, const CBigNum& b);
     friend inline bool operator<(const CBigNum& a, const CBigNum& b);
     friend inline bool operator>(const CBigNum& a, const CBigNum& b);
+    friend class CBigNumFixedBase;
+};
+
+/** Precomputed powers of a base that is raised to many different exponents modulo the same
+ *  modulus, such as the group generators of libzerocoin. An exponentiation then costs one
+ *  modular multiplication per window of the exponent and no squarings.
+ *  Results are identical to base.pow_mod(e, modulus), including negative exponents.
+ *  Table lookups depend on the exponent, so only use this for public exponents.
+ */
+class CBigNumFixedBase
+{
+public:
+    /**
+     * @param base the fixed base
+     * @param order the order of base, exponents are reduced modulo it
+     * @param modulus the modulus
+     */
+    CBigNumFixedBase(const CBigNum& base, const CBigNum& order, const CBigNum& modulus);
+
+    /**
+     * modular exponentiation: base^e mod modulus
+     * @param e exponent
+     */
+    CBigNum pow_mod(const CBigNum& e) const;
+
+    /**
+     * simultaneous modular exponentiation: (base^e1 * other^e2) mod modulus
+     * @param e1 exponent of this base
+     * @param other second fixed base, with the same modulus
+     * @param e2 exponent of the second base
+     */
+    CBigNum mul_pow_mod(const CBigNum& e1, const CBigNumFixedBase& other, const CBigNum& e2) const;
+
+private:
+    static const unsigned int WINDOW_BITS = 5;
+    static const unsigned int WINDOW_SIZE = (1 << WINDOW_BITS) - 1;
+
+    CBigNum base;
+    CBigNum order;
+    CBigNum modulus;
+    // table[j * WINDOW_SIZE + d - 1] = base^(d * 2^(j * WINDOW_BITS)), empty if base^order != 1
+    std::vector<CBigNum> table;
+
+    void MulPow(CBigNum& acc, const CBigNum& e) const;
 };
 
 #if defined(USE_NUM_OPENSSL)
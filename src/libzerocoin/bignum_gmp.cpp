@@ -246,6 +246,68 @@ CBigNum CBigNum::pow_mod(const CBigNum& e, const CBigNum& m) const
     return ret;
 }
 
+CBigNumFixedBase::CBigNumFixedBase(const CBigNum& baseIn, const CBigNum& orderIn, const CBigNum& modulusIn) :
+    base(baseIn), order(orderIn), modulus(modulusIn)
+{
+    // Reducing exponents modulo the order is only exact if it really is the order of base
+    if (order <= CBigNum(1) || modulus <= CBigNum(1) || !base.pow_mod(order, modulus).isOne())
+        return;
+
+    const unsigned int nWindows = (mpz_sizeinbase(order.bn, 2) + WINDOW_BITS - 1) / WINDOW_BITS;
+    table.resize(nWindows * WINDOW_SIZE);
+
+    CBigNum windowBase = base;
+    for (unsigned int j = 0; j < nWindows; j++) {
+        CBigNum* row = &table[j * WINDOW_SIZE];
+        row[0] = windowBase;
+        for (unsigned int d = 1; d < WINDOW_SIZE; d++) {
+            mpz_mul(row[d].bn, row[d - 1].bn, windowBase.bn);
+            mpz_mod(row[d].bn, row[d].bn, modulus.bn);
+        }
+        // base^(2^((j + 1) * WINDOW_BITS))
+        mpz_mul(windowBase.bn, row[WINDOW_SIZE - 1].bn, windowBase.bn);
+        mpz_mod(windowBase.bn, windowBase.bn, modulus.bn);
+    }
+}
+
+void CBigNumFixedBase::MulPow(CBigNum& acc, const CBigNum& e) const
+{
+    CBigNum exp;
+    mpz_mod(exp.bn, e.bn, order.bn);
+
+    const unsigned int nWindows = table.size() / WINDOW_SIZE;
+    for (unsigned int j = 0; j < nWindows; j++) {
+        unsigned int d = 0;
+        for (unsigned int k = 0; k < WINDOW_BITS; k++)
+            d |= mpz_tstbit(exp.bn, j * WINDOW_BITS + k) << k;
+        if (d == 0)
+            continue;
+        mpz_mul(acc.bn, acc.bn, table[j * WINDOW_SIZE + d - 1].bn);
+        mpz_mod(acc.bn, acc.bn, modulus.bn);
+    }
+}
+
+CBigNum CBigNumFixedBase::pow_mod(const CBigNum& e) const
+{
+    if (table.empty())
+        return base.pow_mod(e, modulus);
+
+    CBigNum ret = 1;
+    MulPow(ret, e);
+    return ret;
+}
+
+CBigNum CBigNumFixedBase::mul_pow_mod(const CBigNum& e1, const CBigNumFixedBase& other, const CBigNum& e2) const
+{
+    if (table.empty() || other.table.empty() || modulus != other.modulus)
+        return pow_mod(e1).mul_mod(other.base.pow_mod(e2, modulus), modulus);
+
+    CBigNum ret = 1;
+    MulPow(ret, e1);
+    other.MulPow(ret, e2);
+    return ret;
+}
+
 /**
 * Calculates the inverse of this element mod m.
 * i.e. i such this*i = 1 mod m
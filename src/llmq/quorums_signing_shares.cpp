@@ -2,6 +2,7 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "quorums_init.h"
 #include "quorums_signing.h"
 #include "quorums_signing_shares.h"
 #include "quorums_utils.h"
@@ -581,7 +582,7 @@ bool CSigSharesManager::ProcessPendingSigShares(CConnman& connman)
 
     // It's ok to perform insecure batched verification here as we verify against the quorum public key shares,
     // which are not craftable by individual entities, making the rogue public key attack impossible
-    CBLSBatchVerifier<NodeId, SigShareKey> batchVerifier(false, true);
+    CBLSBatchVerifier<NodeId, SigShareKey> batchVerifier(false, true, 0, blsWorker);
 
     size_t verifyCount = 0;
     for (auto& p : sigSharesByNodes) {
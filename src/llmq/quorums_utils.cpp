@@ -8,17 +8,71 @@
 
 #include "chainparams.h"
 #include "random.h"
+#include "saltedhasher.h"
+#include "unordered_lru_cache.h"
 #include "validation.h"
 
+#include <atomic>
+
 namespace llmq
 {
 
+static CCriticalSection cs_quorumMembersCache;
+// keyed by the quorum modifier, which is the hash of (llmqType, quorumHash)
+static unordered_lru_cache<uint256, std::vector<CDeterministicMNCPtr>, StaticSaltedHasher> quorumMembersCache(QUORUM_MEMBERS_CACHE_SIZE);
+// keyed by the hash of (modifier, forMember)
+static unordered_lru_cache<uint256, std::set<uint256>, StaticSaltedHasher> quorumConnectionsCache(QUORUM_MEMBERS_CACHE_SIZE * 10);
+// incremented on invalidation, so that results calculated from an old masternode list are not cached
+static uint64_t nQuorumMembersCacheGeneration = 0;
+
+static std::atomic<uint64_t> nQuorumMembersHits{0};
+static std::atomic<uint64_t> nQuorumMembersMisses{0};
+static std::atomic<uint64_t> nQuorumConnectionsHits{0};
+static std::atomic<uint64_t> nQuorumConnectionsMisses{0};
+
 std::vector<CDeterministicMNCPtr> CLLMQUtils::GetAllQuorumMembers(Consensus::LLMQType llmqType, const CBlockIndex* pindexQuorum)
 {
+    auto modifier = ::SerializeHash(std::make_pair(llmqType, pindexQuorum->GetBlockHash()));
+
+    std::vector<CDeterministicMNCPtr> members;
+    uint64_t nGeneration;
+    {
+        LOCK(cs_quorumMembersCache);
+        if (quorumMembersCache.get(modifier, members)) {
+            nQuorumMembersHits++;
+            return members;
+        }
+        nGeneration = nQuorumMembersCacheGeneration;
+    }
+    nQuorumMembersMisses++;
+
     auto& params = Params().GetConsensus().llmqs.at(llmqType);
     auto allMns = deterministicMNManager->GetListForBlock(pindexQuorum);
-    auto modifier = ::SerializeHash(std::make_pair(llmqType, pindexQuorum->GetBlockHash()));
-    return allMns.CalculateQuorum(params.size, modifier);
+    members = allMns.CalculateQuorum(params.size, modifier);
+
+    LOCK(cs_quorumMembersCache);
+    if (nGeneration == nQuorumMembersCacheGeneration) {
+        quorumMembersCache.insert(modifier, members);
+    }
+    return members;
+}
+
+void CLLMQUtils::InvalidateQuorumMembersCache()
+{
+    LOCK(cs_quorumMembersCache);
+    quorumMembersCache.clear();
+    quorumConnectionsCache.clear();
+    nQuorumMembersCacheGeneration++;
+}
+
+CQuorumMembersCacheStats CLLMQUtils::GetQuorumMembersCacheStats()
+{
+    CQuorumMembersCacheStats stats;
+    stats.nMembersHits = nQuorumMembersHits;
+    stats.nMembersMisses = nQuorumMembersMisses;
+    stats.nConnectionsHits = nQuorumConnectionsHits;
+    stats.nConnectionsMisses = nQuorumConnectionsMisses;
+    return stats;
 }
 
 uint256 CLLMQUtils::BuildCommitmentHash(Consensus::LLMQType llmqType, const uint256& blockHash, const std::vector<bool>& validMembers, const CBLSPublicKey& pubKey, const uint256& vvecHash)
@@ -44,10 +98,22 @@ uint256 CLLMQUtils::BuildSignHash(Consensus::LLMQType llmqType, const uint256& q
 
 std::set<uint256> CLLMQUtils::GetQuorumConnections(Consensus::LLMQType llmqType, const CBlockIndex* pindexQuorum, const uint256& forMember)
 {
-    auto& params = Params().GetConsensus().llmqs.at(llmqType);
+    auto modifier = ::SerializeHash(std::make_pair(llmqType, pindexQuorum->GetBlockHash()));
+    auto cacheKey = ::SerializeHash(std::make_pair(modifier, forMember));
 
-    auto mns = GetAllQuorumMembers(llmqType, pindexQuorum);
     std::set<uint256> result;
+    uint64_t nGeneration;
+    {
+        LOCK(cs_quorumMembersCache);
+        if (quorumConnectionsCache.get(cacheKey, result)) {
+            nQuorumConnectionsHits++;
+            return result;
+        }
+        nGeneration = nQuorumMembersCacheGeneration;
+    }
+    nQuorumConnectionsMisses++;
+
+    auto mns = GetAllQuorumMembers(llmqType, pindexQuorum);
     for (size_t i = 0; i < mns.size(); i++) {
         auto& dmn = mns[i];
         if (dmn->proTxHash == forMember) {
@@ -71,6 +137,11 @@ std::set<uint256> CLLMQUtils::GetQuorumConnections(Consensus::LLMQType llmqType,
             break;
         }
     }
+
+    LOCK(cs_quorumMembersCache);
+    if (nGeneration == nQuorumMembersCacheGeneration) {
+        quorumConnectionsCache.insert(cacheKey, result);
+    }
     return result;
 }
 
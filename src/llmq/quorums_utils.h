@@ -16,11 +16,26 @@
 namespace llmq
 {
 
+// Number of quorums for which members and connections are kept in memory
+static const size_t QUORUM_MEMBERS_CACHE_SIZE = 100;
+
+struct CQuorumMembersCacheStats
+{
+    uint64_t nMembersHits;
+    uint64_t nMembersMisses;
+    uint64_t nConnectionsHits;
+    uint64_t nConnectionsMisses;
+};
+
 class CLLMQUtils
 {
 public:
     // includes members which failed DKG
+    // the result is cached per quorum, as calculating it scores and sorts the whole masternode list
     static std::vector<CDeterministicMNCPtr> GetAllQuorumMembers(Consensus::LLMQType llmqType, const CBlockIndex* pindexQuorum);
+    // must be called when blocks are disconnected, as the masternode list of a quorum block may change then
+    static void InvalidateQuorumMembersCache();
+    static CQuorumMembersCacheStats GetQuorumMembersCacheStats();
 
     static uint256 BuildCommitmentHash(Consensus::LLMQType llmqType, const uint256& blockHash, const std::vector<bool>& validMembers, const CBLSPublicKey& pubKey, const uint256& vvecHash);
     static uint256 BuildSignHash(Consensus::LLMQType llmqType, const uint256& quorumHash, const uint256& id, const uint256& msgHash);
@@ -5,6 +5,7 @@
 #include "mining-manager.h"
 
 #include "chainparams.h"
+#include "crypto/x11.h"
 #include "init.h"
 #include "miner.h"
 #include "net.h"
@@ -15,9 +16,11 @@
 #include "pos/stakeinput.h"
 #include "script/sign.h"
 #include "script/tokengroup.h"
+#include "streams.h"
 #include "tokens/tokengroupmanager.h"
 #include "utilmoneystr.h"
 #include "validation.h"
+#include "versionbits.h"
 #include "wallet/wallet.h"
 
 // fix windows build
@@ -39,6 +42,30 @@ std::shared_ptr<CMiningManager> miningManager;
 
 bool static ScanHash(const CBlockHeader *pblock, const arith_uint256& hashTarget, uint32_t& nNonce, uint256& phash)
 {
+    if ((pblock->nVersion & BLOCKTYPEBITS_MASK) == BlockTypeBits::BLOCKTYPE_MINING) {
+        // Serialize the header once and let the hasher patch the nonce and
+        // hash a batch of nonces at a time
+        std::vector<unsigned char> vch;
+        CVectorWriter ss(SER_NETWORK, PROTOCOL_VERSION, vch, 0);
+        ss << *pblock;
+        CX11NonceHasher hasher(vch.data(), vch.size());
+
+        uint256 hashes[CX11NonceHasher::BATCH_SIZE];
+        while (true) {
+            hasher.Hash(nNonce + 1, CX11NonceHasher::BATCH_SIZE, hashes[0].begin());
+            for (const uint256& hash : hashes) {
+                nNonce++;
+                if (UintToArith256(hash) <= hashTarget) {
+                    phash = hash;
+                    return true;
+                }
+                // If nothing found after trying for a while, return -1
+                if ((nNonce & 0xfff) == 0)
+                    return false;
+            }
+        }
+    }
+
     // HashX11 currently does not have an intermediary state
     // So we revert to doing a full hash calculation and check
     CBlockHeader block = *pblock;
@@ -1278,35 +1278,22 @@ void CConnman::ThreadSocketHandler()
         //
         // Find which sockets have data to receive
         //
-        struct timeval timeout;
-        timeout.tv_sec  = 0;
-        timeout.tv_usec = 50000; // frequency to poll pnode->vSend
-
-        fd_set fdsetRecv;
-        fd_set fdsetSend;
-        fd_set fdsetError;
-        FD_ZERO(&fdsetRecv);
-        FD_ZERO(&fdsetSend);
-        FD_ZERO(&fdsetError);
-        SOCKET hSocketMax = 0;
-        bool have_fds = false;
+        static const int64_t nSocketEventsTimeout = 50; // frequency to poll pnode->vSend
 
 #ifndef WIN32
-        // We add a pipe to the read set so that the select() call can be woken up from the outside
+        // We add a pipe to the read set so that the wait can be woken up from the outside
         // This is done when data is available for sending and at the same time optimistic sending was disabled
         // when pushing the data.
         // This is currently only implemented for POSIX compliant systems. This means that Windows will fall back to
         // timing out after 50ms and then trying to send. This is ok as we assume that heavy-load daemons are usually
         // run on Linux and friends.
-        FD_SET(wakeupPipe[0], &fdsetRecv);
-        hSocketMax = std::max(hSocketMax, (SOCKET)wakeupPipe[0]);
-        have_fds = true;
+        if (wakeupPipe[0] != -1)
+            socketEvents->Set(wakeupPipe[0], -2, SOCKET_EVENT_RECV);
 #endif
 
         for (const ListenSocket& hListenSocket : vhListenSocket) {
-            FD_SET(hListenSocket.socket, &fdsetRecv);
-            hSocketMax = std::max(hSocketMax, hListenSocket.socket);
-            have_fds = true;
+            if (hListenSocket.socket != INVALID_SOCKET)
+                socketEvents->Set(hListenSocket.socket, -1, SOCKET_EVENT_RECV);
         }
 
         {
@@ -1314,15 +1301,17 @@ void CConnman::ThreadSocketHandler()
             for (CNode* pnode : vNodes)
             {
                 // Implement the following logic:
-                // * If there is data to send, select() for sending data. As this only
+                // * If there is data to send, wait for sending data. As this only
                 //   happens when optimistic write failed, we choose to first drain the
                 //   write buffer in this case before receiving more. This avoids
                 //   needlessly queueing received data, if the remote peer is not themselves
                 //   receiving data. This means properly utilizing TCP flow control signalling.
-                // * Otherwise, if there is space left in the receive buffer, select() for
+                // * Otherwise, if there is space left in the receive buffer, wait for
                 //   receiving data.
                 // * Hand off all complete messages to the processor, to be handled without
                 //   blocking here.
+                // Sockets stay registered across iterations, only changed events are passed
+                // on to the backend.
 
                 bool select_recv = !pnode->fPauseRecv;
                 bool select_send;
@@ -1335,46 +1324,42 @@ void CConnman::ThreadSocketHandler()
                 if (pnode->hSocket == INVALID_SOCKET)
                     continue;
 
-                FD_SET(pnode->hSocket, &fdsetError);
-                hSocketMax = std::max(hSocketMax, pnode->hSocket);
-                have_fds = true;
-
+                uint8_t events = 0;
                 if (select_send) {
-                    FD_SET(pnode->hSocket, &fdsetSend);
-                    continue;
-                }
-                if (select_recv) {
-                    FD_SET(pnode->hSocket, &fdsetRecv);
+                    events = SOCKET_EVENT_SEND;
+                } else if (select_recv) {
+                    events = SOCKET_EVENT_RECV;
                 }
+                socketEvents->Set(pnode->hSocket, pnode->GetId(), events);
             }
         }
+        // Remove the sockets of disconnected nodes
+        socketEvents->Sweep();
 
+        std::unordered_map<SOCKET, uint8_t> mapReady;
         wakeupSelectNeeded = true;
-        int nSelect = select(have_fds ? hSocketMax + 1 : 0,
-                             &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
+        bool fWaited = socketEvents->Wait(nSocketEventsTimeout, mapReady);
         wakeupSelectNeeded = false;
         if (interruptNet)
             return;
 
-        if (nSelect == SOCKET_ERROR)
+        if (!fWaited)
         {
-            if (have_fds)
-            {
-                int nErr = WSAGetLastError();
-                LogPrintf("socket select error %s\n", NetworkErrorString(nErr));
-                for (unsigned int i = 0; i <= hSocketMax; i++)
-                    FD_SET(i, &fdsetRecv);
-            }
-            FD_ZERO(&fdsetSend);
-            FD_ZERO(&fdsetError);
-            if (!interruptNet.sleep_for(std::chrono::milliseconds(timeout.tv_usec/1000)))
+            int nErr = WSAGetLastError();
+            LogPrintf("socket %s error %s\n", SocketEventsModeToString(socketEvents->GetMode()), NetworkErrorString(nErr));
+            if (!interruptNet.sleep_for(std::chrono::milliseconds(nSocketEventsTimeout)))
                 return;
         }
 
+        auto isReady = [&mapReady](SOCKET s, uint8_t events) {
+            auto it = mapReady.find(s);
+            return it != mapReady.end() && (it->second & events);
+        };
+
 #ifndef WIN32
         // drain the wakeup pipe
-        if (FD_ISSET(wakeupPipe[0], &fdsetRecv)) {
-            LogPrint(BCLog::NET, "woke up select()\n");
+        if (wakeupPipe[0] != -1 && isReady(wakeupPipe[0], SOCKET_EVENT_RECV)) {
+            LogPrint(BCLog::NET, "woke up socket events\n");
             char buf[128];
             while (true) {
                 int r = read(wakeupPipe[0], buf, sizeof(buf));
@@ -1390,7 +1375,7 @@ void CConnman::ThreadSocketHandler()
         //
         for (const ListenSocket& hListenSocket : vhListenSocket)
         {
-            if (hListenSocket.socket != INVALID_SOCKET && FD_ISSET(hListenSocket.socket, &fdsetRecv))
+            if (hListenSocket.socket != INVALID_SOCKET && isReady(hListenSocket.socket, SOCKET_EVENT_RECV))
             {
                 AcceptConnection(hListenSocket);
             }
@@ -1415,9 +1400,9 @@ void CConnman::ThreadSocketHandler()
                 LOCK(pnode->cs_hSocket);
                 if (pnode->hSocket == INVALID_SOCKET)
                     continue;
-                recvSet = FD_ISSET(pnode->hSocket, &fdsetRecv);
-                sendSet = FD_ISSET(pnode->hSocket, &fdsetSend);
-                errorSet = FD_ISSET(pnode->hSocket, &fdsetError);
+                recvSet = isReady(pnode->hSocket, SOCKET_EVENT_RECV);
+                sendSet = isReady(pnode->hSocket, SOCKET_EVENT_SEND);
+                errorSet = isReady(pnode->hSocket, SOCKET_EVENT_ERR);
             }
             if (recvSet || errorSet)
             {
@@ -1450,7 +1435,7 @@ void CConnman::ThreadSocketHandler()
                             pnode->nProcessQueueSize += nSizeAdded;
                             pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
                         }
-                        WakeMessageHandler();
+                        WakeMessageHandler(pnode);
                     }
                 }
                 else if (nBytes == 0)
@@ -1525,11 +1510,26 @@ void CConnman::ThreadSocketHandler()
 
 void CConnman::WakeMessageHandler()
 {
-    {
-        std::lock_guard<std::mutex> lock(mutexMsgProc);
-        fMsgProcWake = true;
+    std::lock_guard<std::mutex> lock(mutexMsgProc);
+    for (auto& worker : vMessageHandlerWorkers) {
+        worker->fMsgProcWake = true;
+        worker->condMsgProc.notify_one();
     }
-    condMsgProc.notify_one();
+}
+
+void CConnman::WakeMessageHandler(const CNode* pnode)
+{
+    std::lock_guard<std::mutex> lock(mutexMsgProc);
+    if (vMessageHandlerWorkers.empty())
+        return;
+    MessageHandlerWorker& worker = *vMessageHandlerWorkers[GetMessageHandlerWorker(pnode)];
+    worker.fMsgProcWake = true;
+    worker.condMsgProc.notify_one();
+}
+
+size_t CConnman::GetMessageHandlerWorker(const CNode* pnode) const
+{
+    return (size_t)pnode->GetId() % nMessageHandlerThreads;
 }
 
 void CConnman::WakeSelect()
@@ -2221,8 +2221,9 @@ bool CConnman::OpenMasternodeConnection(const CAddress &addrConnect) {
     return OpenNetworkConnection(addrConnect, false, nullptr, nullptr, false, false, false, true);
 }
 
-void CConnman::ThreadMessageHandler()
+void CConnman::ThreadMessageHandler(size_t nWorker)
 {
+    MessageHandlerWorker& worker = *vMessageHandlerWorkers[nWorker];
     while (!flagInterruptMsgProc)
     {
         std::vector<CNode*> vNodesCopy = CopyNodeVector();
@@ -2231,7 +2232,7 @@ void CConnman::ThreadMessageHandler()
 
         for (CNode* pnode : vNodesCopy)
         {
-            if (pnode->fDisconnect)
+            if (pnode->fDisconnect || GetMessageHandlerWorker(pnode) != nWorker)
                 continue;
 
             // Receive messages
@@ -2253,9 +2254,9 @@ void CConnman::ThreadMessageHandler()
 
         std::unique_lock<std::mutex> lock(mutexMsgProc);
         if (!fMoreWork) {
-            condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [this] { return fMsgProcWake; });
+            worker.condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [&worker] { return worker.fMsgProcWake; });
         }
-        fMsgProcWake = false;
+        worker.fMsgProcWake = false;
     }
 }
 
@@ -2509,6 +2510,17 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         return false;
     }
 
+    socketEvents = CSocketEvents::Create(socketEventsMode);
+    if (!socketEvents) {
+        if (clientInterface) {
+            clientInterface->ThreadSafeMessageBox(
+                strprintf(_("Failed to create socket events handler (%s)."), SocketEventsModeToString(socketEventsMode)),
+                "", CClientUIInterface::MSG_ERROR);
+        }
+        return false;
+    }
+    LogPrintf("Using %s for socket events\n", SocketEventsModeToString(socketEventsMode));
+
     for (const auto& strDest : connOptions.vSeedNodes) {
         AddOneShot(strDest);
     }
@@ -2575,7 +2587,11 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
 
     {
         std::unique_lock<std::mutex> lock(mutexMsgProc);
-        fMsgProcWake = false;
+        assert(vMessageHandlerWorkers.empty());
+        for (int i = 0; i < nMessageHandlerThreads; i++) {
+            vMessageHandlerWorkers.emplace_back(new MessageHandlerWorker());
+            vMessageHandlerWorkers.back()->strThreadName = i == 0 ? "msghand" : strprintf("msghand.%d", i);
+        }
     }
 
 #ifndef WIN32
@@ -2613,7 +2629,10 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
     threadOpenMasternodeConnections = std::thread(&TraceThread<std::function<void()> >, "mncon", std::function<void()>(std::bind(&CConnman::ThreadOpenMasternodeConnections, this)));
 
     // Process messages
-    threadMessageHandler = std::thread(&TraceThread<std::function<void()> >, "msghand", std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this)));
+    for (size_t i = 0; i < vMessageHandlerWorkers.size(); i++) {
+        MessageHandlerWorker& worker = *vMessageHandlerWorkers[i];
+        worker.thread = std::thread(&TraceThread<std::function<void()> >, worker.strThreadName.c_str(), std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this, i)));
+    }
 
     // Dump network addresses
     scheduler.scheduleEvery(std::bind(&CConnman::DumpData, this), DUMP_ADDRESSES_INTERVAL * 1000);
@@ -2649,8 +2668,10 @@ void CConnman::Interrupt()
     {
         std::lock_guard<std::mutex> lock(mutexMsgProc);
         flagInterruptMsgProc = true;
+        for (auto& worker : vMessageHandlerWorkers) {
+            worker->condMsgProc.notify_all();
+        }
     }
-    condMsgProc.notify_all();
 
     interruptNet();
     InterruptSocks5(true);
@@ -2677,8 +2698,14 @@ void CConnman::Interrupt()
 
 void CConnman::Stop()
 {
-    if (threadMessageHandler.joinable())
-        threadMessageHandler.join();
+    for (auto& worker : vMessageHandlerWorkers) {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutexMsgProc);
+        vMessageHandlerWorkers.clear();
+    }
     if (threadOpenMasternodeConnections.joinable())
         threadOpenMasternodeConnections.join();
     if (threadOpenConnections.joinable())
@@ -2720,6 +2747,7 @@ void CConnman::Stop()
     semAddnode = nullptr;
     delete semMasternodeOutbound;
     semMasternodeOutbound = nullptr;
+    socketEvents.reset();
 
 #ifndef WIN32
     if (wakeupPipe[0] != -1) close(wakeupPipe[0]);
@@ -19,6 +19,7 @@
 #include "protocol.h"
 #include "random.h"
 #include "saltedhasher.h"
+#include "socketevents.h"
 #include "streams.h"
 #include "sync.h"
 #include "uint256.h"
@@ -111,6 +112,9 @@ static const bool DEFAULT_BLOCKSONLY = false;
 static const bool DEFAULT_FORCEDNSSEED = false;
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
+/** -msghandlerthreads default, each peer is always processed by the same thread */
+static const int DEFAULT_MSG_HANDLER_THREADS = 1;
+static const int MAX_MSG_HANDLER_THREADS = 16;
 
 // NOTE: When adjusting this, update rpcnet:setban's help ("24h")
 static const unsigned int DEFAULT_MISBEHAVING_BANTIME = 60 * 60 * 24;  // Default 24-hour ban
@@ -170,6 +174,8 @@ public:
         std::vector<std::string> vSeedNodes;
         std::vector<CSubNet> vWhitelistedRange;
         std::vector<CService> vBinds, vWhiteBinds;
+        SocketEventsMode socketEventsMode = DEFAULT_SOCKETEVENTS;
+        int nMessageHandlerThreads = DEFAULT_MSG_HANDLER_THREADS;
     };
 
     void Init(const Options& connOptions) {
@@ -186,6 +192,8 @@ public:
         nMaxOutboundTimeframe = connOptions.nMaxOutboundTimeframe;
         nMaxOutboundLimit = connOptions.nMaxOutboundLimit;
         vWhitelistedRange = connOptions.vWhitelistedRange;
+        socketEventsMode = connOptions.socketEventsMode;
+        nMessageHandlerThreads = std::max(1, std::min(connOptions.nMessageHandlerThreads, MAX_MSG_HANDLER_THREADS));
     }
 
     CConnman(uint64_t seed0, uint64_t seed1);
@@ -450,7 +458,10 @@ public:
 
     unsigned int GetReceiveFloodSize() const;
 
+    /** Wake all message handler threads */
     void WakeMessageHandler();
+    /** Wake the message handler thread that processes pnode */
+    void WakeMessageHandler(const CNode* pnode);
     void WakeSelect();
 
     int GetMinPeerVersion();
@@ -470,7 +481,8 @@ private:
     void AddOneShot(const std::string& strDest);
     void ProcessOneShot();
     void ThreadOpenConnections();
-    void ThreadMessageHandler();
+    void ThreadMessageHandler(size_t nWorker);
+    size_t GetMessageHandlerWorker(const CNode* pnode) const;
     void AcceptConnection(const ListenSocket& hListenSocket);
     void ThreadSocketHandler();
     void ThreadDNSAddressSeed();
@@ -564,27 +576,43 @@ private:
     /** SipHasher seeds for deterministic randomness */
     const uint64_t nSeed0, nSeed1;
 
-    /** flag for waking the message processor. */
-    bool fMsgProcWake;
+    /**
+     * A message handler thread. Peers are pinned to a thread by their id, which keeps the
+     * order in which the messages of a peer are processed, while different peers are
+     * processed concurrently.
+     */
+    struct MessageHandlerWorker
+    {
+        std::string strThreadName;
+        std::thread thread;
+        /** flag for waking the message processor. */
+        bool fMsgProcWake{false};
+        std::condition_variable condMsgProc;
+    };
 
-    std::condition_variable condMsgProc;
+    int nMessageHandlerThreads;
+    std::vector<std::unique_ptr<MessageHandlerWorker>> vMessageHandlerWorkers;
+    /** Protects fMsgProcWake of all workers */
     std::mutex mutexMsgProc;
     std::atomic<bool> flagInterruptMsgProc;
 
     CThreadInterrupt interruptNet;
 
 #ifndef WIN32
-    /** a pipe which is added to select() calls to wakeup before the timeout */
+    /** a pipe which is added to the socket events to wakeup before the timeout */
     int wakeupPipe[2]{-1,-1};
 #endif
     std::atomic<bool> wakeupSelectNeeded{false};
 
+    SocketEventsMode socketEventsMode;
+    /** Only used by the socket handler thread */
+    std::unique_ptr<CSocketEvents> socketEvents;
+
     std::thread threadDNSAddressSeed;
     std::thread threadSocketHandler;
     std::thread threadOpenAddedConnections;
     std::thread threadOpenConnections;
     std::thread threadOpenMasternodeConnections;
-    std::thread threadMessageHandler;
 
     /** flag for deciding to connect to an extra outbound peer,
      *  in excess of nMaxOutbound
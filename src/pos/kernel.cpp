@@ -8,6 +8,7 @@
 #include <algorithm>
 
 #include "consensus/tokengroups.h"
+#include "crypto/common.h"
 #include "wallet/db.h"
 #include "kernel.h"
 #include "policy/policy.h"
@@ -255,50 +256,20 @@ bool GetKernelStakeModifier(uint256 hashBlockFrom, uint64_t& nStakeModifier, int
     return true;
 }
 
-bool CheckStakeKernelHash(const CBlockIndex* pindexPrev, const unsigned int nBits, CStakeInput* stake, const unsigned int nTimeTx, uint256& hashProofOfStake, const bool fVerify)
+// Serializes everything the proof of stake hash commits to, except the transaction time which comes last
+static bool GetStakeKernelPrefix(const CBlockIndex* pindexPrev, CStakeInput* stake, CDataStream& ss)
 {
-    // Calculate the proof of stake hash
-    if (!GetHashProofOfStake(pindexPrev, stake, nTimeTx, fVerify, hashProofOfStake)) {
-        return error("%s : Failed to calculate the proof of stake hash", __func__);
-    }
-
-    // Base target
-    arith_uint256 bnTarget;
-    bnTarget.SetCompact(nBits);
-
-    // Weighted target
-    bnTarget *= (arith_uint256(stake->GetValue()) / 100);
-
-    // Check if proof-of-stake hash meets target protocol
-    const arith_uint256 proof = UintToArith256(hashProofOfStake);
-    const bool res = (UintToArith256(hashProofOfStake) < bnTarget);
-
-    bool fPreDGW = (pindexPrev->nHeight + 1) < Params().GetConsensus().DGWStartHeight || nTimeTx < (unsigned int)Params().GetConsensus().DGWStartTime;
-    return res || fPreDGW;
-}
-
-bool GetHashProofOfStakePreDGW(const CBlockIndex* pindexPrev, CStakeInput* stake, const unsigned int nTimeTx, const bool fVerify, uint256& hashProofOfStakeRet) {
     // Grab the stake data
     CBlockIndex* pindexfrom = stake->GetIndexFrom();
+    if (!pindexfrom) return error("%s : Failed to find the block index for stake origin", __func__);
     const unsigned int nTimeBlockFrom = pindexfrom->nTime;
 
-    CDataStream ss(SER_GETHASH, 0);
-    ss << nTimeBlockFrom << uint256() << stake->GetValue() << nTimeTx;
-    hashProofOfStakeRet = Hash(ss.begin(), ss.end());
-
-    return true;
-}
-
-bool GetHashProofOfStake(const CBlockIndex* pindexPrev, CStakeInput* stake, const unsigned int nTimeTx, const bool fVerify, uint256& hashProofOfStakeRet) {
-    if (pindexPrev->nHeight < Params().GetConsensus().DGWStartHeight)
-        return GetHashProofOfStakePreDGW(pindexPrev, stake, nTimeTx, fVerify, hashProofOfStakeRet);
+    if (pindexPrev->nHeight < Params().GetConsensus().DGWStartHeight) {
+        ss << nTimeBlockFrom << uint256() << stake->GetValue();
+        return true;
+    }
 
-    // Grab the stake data
-    CBlockIndex* pindexfrom = stake->GetIndexFrom();
-    if (!pindexfrom) return error("%s : Failed to find the block index for stake origin", __func__);
     const CDataStream& ssUniqueID = stake->GetUniqueness();
-    const unsigned int nTimeBlockFrom = pindexfrom->nTime;
-    CDataStream modifier_ss(SER_GETHASH, 0);
 
     // Hash the modifier
     if ((pindexPrev->nHeight + 1) < Params().GetConsensus().nBlockStakeModifierV2) {
@@ -306,16 +277,74 @@ bool GetHashProofOfStake(const CBlockIndex* pindexPrev, CStakeInput* stake, cons
         uint64_t nStakeModifier = 0;
         if (!stake->GetModifier(nStakeModifier))
             return error("%s : Failed to get kernel stake modifier", __func__);
-        modifier_ss << nStakeModifier;
+        ss << nStakeModifier;
     } else {
         // Modifier v2
-        const arith_uint256 prevModifier = UintToArith256(pindexPrev->nStakeModifierV2);
-        modifier_ss << pindexPrev->nStakeModifierV2;
+        ss << pindexPrev->nStakeModifierV2;
+    }
+
+    ss << nTimeBlockFrom << ssUniqueID;
+    return true;
+}
+
+bool CStakeKernel::Init(const CBlockIndex* pindexPrev, const unsigned int nBits, CStakeInput* stake)
+{
+    CDataStream ss(SER_GETHASH, 0);
+    if (!GetStakeKernelPrefix(pindexPrev, stake, ss))
+        return false;
+    hasherPrefix.Reset();
+    hasherPrefix.Write((const unsigned char*)ss.data(), ss.size());
+
+    // Weighted target
+    bnTarget.SetCompact(nBits);
+    bnTarget *= (arith_uint256(stake->GetValue()) / 100);
+
+    fPreDGWHeight = (pindexPrev->nHeight + 1) < Params().GetConsensus().DGWStartHeight;
+    return true;
+}
+
+uint256 CStakeKernel::GetHashProofOfStake(const unsigned int nTimeTx) const
+{
+    unsigned char vchTime[4];
+    WriteLE32(vchTime, nTimeTx);
+
+    // Double SHA256, continuing from the prefix midstate
+    unsigned char buf[CSHA256::OUTPUT_SIZE];
+    CSHA256(hasherPrefix).Write(vchTime, sizeof(vchTime)).Finalize(buf);
+    uint256 hash;
+    CSHA256().Write(buf, sizeof(buf)).Finalize(hash.begin());
+    return hash;
+}
+
+bool CStakeKernel::CheckHash(const unsigned int nTimeTx, uint256& hashProofOfStake) const
+{
+    hashProofOfStake = GetHashProofOfStake(nTimeTx);
+
+    // Check if proof-of-stake hash meets target protocol
+    const bool res = (UintToArith256(hashProofOfStake) < bnTarget);
+
+    bool fPreDGW = fPreDGWHeight || nTimeTx < (unsigned int)Params().GetConsensus().DGWStartTime;
+    return res || fPreDGW;
+}
+
+bool CheckStakeKernelHash(const CBlockIndex* pindexPrev, const unsigned int nBits, CStakeInput* stake, const unsigned int nTimeTx, uint256& hashProofOfStake, const bool fVerify)
+{
+    // Calculate the proof of stake hash
+    CStakeKernel kernel;
+    if (!kernel.Init(pindexPrev, nBits, stake)) {
+        return error("%s : Failed to calculate the proof of stake hash", __func__);
     }
 
-    CDataStream ss(modifier_ss);
+    return kernel.CheckHash(nTimeTx, hashProofOfStake);
+}
+
+bool GetHashProofOfStake(const CBlockIndex* pindexPrev, CStakeInput* stake, const unsigned int nTimeTx, const bool fVerify, uint256& hashProofOfStakeRet) {
+    CDataStream ss(SER_GETHASH, 0);
+    if (!GetStakeKernelPrefix(pindexPrev, stake, ss))
+        return false;
+
     // Calculate hash
-    ss << nTimeBlockFrom << ssUniqueID << nTimeTx;
+    ss << nTimeTx;
     hashProofOfStakeRet = Hash(ss.begin(), ss.end());
 
     return true;
@@ -457,7 +486,8 @@ unsigned int GetStakeModifierChecksum(const CBlockIndex* pindex)
     CDataStream ss(SER_GETHASH, 0);
     if (pindex->pprev)
         ss << pindex->pprev->nStakeModifierChecksum;
-    uint256 hashProofOfStake = mapProofOfStake[pindex->GetBlockHash()];
+    uint256 hashProofOfStake;
+    GetProofOfStakeHash(pindex->GetBlockHash(), hashProofOfStake);
     ss << pindex->nFlags << hashProofOfStake << pindex->nStakeModifier;
     uint256 hashChecksum = Hash(ss.begin(), ss.end());
     arith_uint256 arithHashChecksum = UintToArith256(hashChecksum);
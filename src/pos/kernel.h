@@ -6,6 +6,8 @@
 #ifndef BITCOIN_KERNEL_H
 #define BITCOIN_KERNEL_H
 
+#include "arith_uint256.h"
+#include "crypto/sha256.h"
 #include "validation.h"
 #include "stakeinput.h"
 
@@ -31,6 +33,25 @@ bool CheckProofOfStake(const CBlock block, uint256& hashProofOfStake, const CBlo
 bool CheckStakeKernelHash(const CBlockIndex* pindexPrev, const unsigned int nBits, CStakeInput* stake, const unsigned int nTimeTx, uint256& hashProofOfStake, const bool fVerify = false);
 // Returns the proof of stake hash
 bool GetHashProofOfStake(const CBlockIndex* pindexPrev, CStakeInput* stake, const unsigned int nTimeTx, const bool fVerify, uint256& hashProofOfStakeRet);
+
+/** Proof-of-stake kernel of a single stake input. Everything the proof of stake hash commits to except the
+ *  transaction time is hashed once up front, so that scanning a range of timestamps only hashes the
+ *  remaining bytes of each candidate. Init() may touch the chain and the wallet, the hashing methods do not
+ *  and are safe to call from several threads at once. */
+class CStakeKernel
+{
+private:
+    CSHA256 hasherPrefix;
+    arith_uint256 bnTarget;
+    bool fPreDGWHeight{false};
+
+public:
+    bool Init(const CBlockIndex* pindexPrev, const unsigned int nBits, CStakeInput* stake);
+    uint256 GetHashProofOfStake(const unsigned int nTimeTx) const;
+    // Same result as CheckStakeKernelHash() for the stake input this kernel was initialized with
+    bool CheckHash(const unsigned int nTimeTx, uint256& hashProofOfStake) const;
+};
+
 // Get stake modifier checksum
 unsigned int GetStakeModifierChecksum(const CBlockIndex* pindex);
 
@@ -13,9 +13,13 @@
 #include "pos/kernel.h"
 #include "pos/stakeinput.h"
 #include "script/sign.h"
+#include "tokens/groups.h"
 #include "validation.h"
 #include "wallet/wallet.h"
 
+#include <atomic>
+#include <future>
+
 // fix windows build
 #include <boost/thread.hpp>
 
@@ -24,30 +28,151 @@ std::shared_ptr<CStakingManager> stakingManager;
 CStakingManager::CStakingManager(CWallet * const pwalletIn) :
         nMintableLastCheck(0), fMintableCoins(false), fLastLoopOrphan(false), nExtraNonce(0), // Currently unused
         fEnableStaking(false), fEnableIONStaking(false), nReserveBalance(0), pwallet(pwalletIn),
-        nHashInterval(22), nLastCoinStakeSearchInterval(0), nLastCoinStakeSearchTime(GetAdjustedTime()) {}
+        nHashInterval(22), nLastCoinStakeSearchInterval(0), nLastCoinStakeSearchTime(GetAdjustedTime())
+{
+    if (pwallet != nullptr) {
+        connNotifyTransactionChanged = pwallet->NotifyTransactionChanged.connect(
+            [this](CWallet* wallet, const uint256& hashTx, ChangeType status) { NotifyTransactionChanged(hashTx); });
+    }
+}
+
+CStakingManager::~CStakingManager()
+{
+    connNotifyTransactionChanged.disconnect();
+    StopWorkers();
+}
+
+// Called with cs_wallet held
+void CStakingManager::NotifyTransactionChanged(const uint256& hashTx)
+{
+    LOCK(cs_stakeCandidates);
+    // Transactions changing before the initial load are picked up by it
+    if (fStakeCandidatesLoaded)
+        setPendingStakeTxes.insert(hashTx);
+}
+
+void CStakingManager::EraseStakeCandidates(const uint256& hashTx)
+{
+    AssertLockHeld(cs_stakeCandidates);
+
+    auto it = mapStakeCandidates.lower_bound(COutPoint(hashTx, 0));
+    while (it != mapStakeCandidates.end() && it->first.hash == hashTx) {
+        setStakeCandidatesByHeight.erase(std::make_pair(it->second.nStakeHeight, it->first));
+        it = mapStakeCandidates.erase(it);
+    }
+}
+
+void CStakingManager::AddStakeCandidates(const uint256& hashTx)
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(pwallet->cs_wallet);
+    AssertLockHeld(cs_stakeCandidates);
+
+    auto mi = pwallet->mapWallet.find(hashTx);
+    if (mi == pwallet->mapWallet.end())
+        return;
+    const CWalletTx& wtx = mi->second;
+    if (wtx.GetDepthInMainChain() < 1)
+        return;
+    const CBlockIndex* pindex = mapBlockIndex.at(wtx.hashBlock);
+
+    // Same rules as CMerkleTx::GetBlocksToMaturity(), relative to the height of the block being staked
+    const Consensus::Params& params = Params().GetConsensus();
+    int nMaturityHeight = pindex->nHeight + 1;
+    if (wtx.IsCoinBase() || wtx.IsCoinStake())
+        nMaturityHeight = std::max(nMaturityHeight, pindex->nHeight + params.nCoinbaseMaturity + 1);
+    if (IsAnyOutputGroupedAuthority(*wtx.tx))
+        nMaturityHeight = std::max(nMaturityHeight, pindex->nHeight + params.nOpGroupNewRequiredConfirmations + 1);
+    const int nStakeHeight = std::max(nMaturityHeight, pindex->nHeight + (int)params.nStakeMinDepth);
+
+    for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+        const CTxOut& txout = wtx.tx->vout[i];
+        if (txout.nValue <= 0 || txout.IsZerocoinMint() || IsOutputGrouped(txout) || txout.nValue == MASTERNODE_COLLATERAL_AMOUNT)
+            continue;
+        if (pwallet->IsSpent(hashTx, i) || (pwallet->IsMine(txout) & ISMINE_SPENDABLE) == ISMINE_NO)
+            continue;
+
+        const COutPoint outpoint(hashTx, i);
+        mapStakeCandidates.emplace(outpoint, CStakeCandidate{wtx.tx, i, pindex->nHeight, pindex->nTime, nMaturityHeight, nStakeHeight});
+        setStakeCandidatesByHeight.emplace(nStakeHeight, outpoint);
+    }
+}
+
+void CStakingManager::UpdateStakeCandidates()
+{
+    std::set<uint256> setPending;
+    {
+        LOCK(cs_stakeCandidates);
+        if (fStakeCandidatesLoaded && setPendingStakeTxes.empty())
+            return;
+        setPending.swap(setPendingStakeTxes);
+    }
+
+    LOCK2(cs_main, pwallet->cs_wallet);
+    LOCK(cs_stakeCandidates);
+
+    if (!fStakeCandidatesLoaded) {
+        // The only full pass over the wallet, everything after this comes from notifications
+        for (const auto& entry : pwallet->mapWallet) {
+            AddStakeCandidates(entry.first);
+        }
+        fStakeCandidatesLoaded = true;
+        LogPrint(BCLog::STAKING, "%s: loaded %d stake candidates\n", __func__, mapStakeCandidates.size());
+        return;
+    }
+
+    // Spending an output, or undoing that spend, changes the candidates of the transaction it came from
+    std::set<uint256> setUpdate(setPending);
+    for (const uint256& hashTx : setPending) {
+        auto mi = pwallet->mapWallet.find(hashTx);
+        if (mi == pwallet->mapWallet.end())
+            continue;
+        for (const CTxIn& txin : mi->second.tx->vin) {
+            if (pwallet->mapWallet.count(txin.prevout.hash))
+                setUpdate.insert(txin.prevout.hash);
+        }
+    }
+
+    for (const uint256& hashTx : setUpdate) {
+        EraseStakeCandidates(hashTx);
+        AddStakeCandidates(hashTx);
+    }
+}
+
+static bool IsMatureStakeCandidate(const CStakeCandidate& candidate, int nContextHeight, uint32_t nContextTime)
+{
+    if (nContextHeight < candidate.nMaturityHeight)
+        return false;
+    return HasStakeMinAgeOrDepth(nContextHeight, nContextTime, candidate.nHeight, candidate.nTime);
+}
 
 bool CStakingManager::MintableCoins()
 {
     if (pwallet == nullptr) return false;
 
-    LOCK2(cs_main, pwallet->cs_wallet);
+    UpdateStakeCandidates();
 
-    int blockHeight = chainActive.Height();
+    // coins are checked against the next block, like SelectStakeCoins does when the coinstake is created
+    int blockHeight = 0;
+    {
+        LOCK(cs_main);
+        blockHeight = chainActive.Height() + 1;
+    }
+    const uint32_t nContextTime = GetAdjustedTime();
+    const bool fStakeModifierV2 = blockHeight >= Params().GetConsensus().nBlockStakeModifierV2;
 
-    std::vector<COutput> vCoins;
-    CCoinControl coin_control;
-    coin_control.nCoinType = CoinType::STAKABLE_COINS;
-    int nMinDepth = blockHeight >= Params().GetConsensus().nBlockStakeModifierV2 ? Params().GetConsensus().nStakeMinDepth : 1;
-    pwallet->AvailableCoins(vCoins, true, &coin_control, 1, MAX_MONEY, MAX_MONEY, 0, nMinDepth);
-    CAmount nAmountSelected = 0;
+    LOCK2(pwallet->cs_wallet, cs_stakeCandidates);
 
-    for (const COutput &out : vCoins) {
-        if (out.tx->tx->vin[0].IsZerocoinSpend() && !out.tx->IsInMainChain())
+    for (const auto& entry : setStakeCandidatesByHeight) {
+        // candidates are ordered by the height they can stake at
+        if (fStakeModifierV2 && entry.first > blockHeight)
+            break;
+
+        if (pwallet->IsLockedCoin(entry.second.hash, entry.second.n))
             continue;
 
-        CBlockIndex* utxoBlock = mapBlockIndex.at(out.tx->hashBlock);
         //check for maturity (min age/depth)
-        if (HasStakeMinAgeOrDepth(blockHeight, GetAdjustedTime(), utxoBlock->nHeight, utxoBlock->GetBlockTime()))
+        if (IsMatureStakeCandidate(mapStakeCandidates.at(entry.second), blockHeight, nContextTime))
             return true;
     }
     return false;
@@ -57,84 +182,116 @@ bool CStakingManager::SelectStakeCoins(std::list<std::unique_ptr<CStakeInput> >&
 {
     if (pwallet == nullptr) return false;
 
-    LOCK2(cs_main, pwallet->cs_wallet);
-    //Add ION
-    std::vector<COutput> vCoins;
-    CCoinControl coin_control;
-    coin_control.nCoinType = CoinType::STAKABLE_COINS;
-    int nMinDepth = blockHeight >= Params().GetConsensus().nBlockStakeModifierV2 ? Params().GetConsensus().nStakeMinDepth : 1;
-    pwallet->AvailableCoins(vCoins, true, &coin_control, 1, MAX_MONEY, MAX_MONEY, 0, nMinDepth);
+    UpdateStakeCandidates();
+
+    const uint32_t nContextTime = GetAdjustedTime();
+    const bool fStakeModifierV2 = blockHeight >= Params().GetConsensus().nBlockStakeModifierV2;
+
+    LOCK2(pwallet->cs_wallet, cs_stakeCandidates);
     CAmount nAmountSelected = 0;
 
-    for (const COutput &out : vCoins) {
+    for (const auto& entry : setStakeCandidatesByHeight) {
+        // candidates are ordered by the height they can stake at
+        if (fStakeModifierV2 && entry.first > blockHeight)
+            break;
+
+        const CStakeCandidate& candidate = mapStakeCandidates.at(entry.second);
+        const CAmount nValue = candidate.tx->vout[candidate.n].nValue;
+
         //make sure not to outrun target amount
-        if (nAmountSelected + out.tx->tx->vout[out.i].nValue > nTargetAmount)
+        if (nAmountSelected + nValue > nTargetAmount)
             continue;
 
-        if (out.tx->tx->vin[0].IsZerocoinSpend() && !out.tx->IsInMainChain())
+        if (pwallet->IsLockedCoin(entry.second.hash, entry.second.n))
             continue;
 
-        CBlockIndex* utxoBlock = mapBlockIndex.at(out.tx->hashBlock);
         //check for maturity (min age/depth)
-        if (!HasStakeMinAgeOrDepth(blockHeight, GetAdjustedTime(), utxoBlock->nHeight, utxoBlock->GetBlockTime()))
+        if (!IsMatureStakeCandidate(candidate, blockHeight, nContextTime))
             continue;
 
         //add to our stake set
-        nAmountSelected += out.tx->tx->vout[out.i].nValue;
+        nAmountSelected += nValue;
 
         std::unique_ptr<CIonStake> input(new CIonStake());
-        input->SetInput(out.tx->tx, out.i);
+        input->SetInput(candidate.tx, candidate.n);
         listInputs.emplace_back(std::move(input));
     }
     return true;
 }
 
-bool CStakingManager::Stake(const CBlockIndex* pindexPrev, CStakeInput* stakeInput, unsigned int nBits, unsigned int& nTimeTx, uint256& hashProofOfStake)
+void CStakingManager::StartWorkers(int nThreads)
 {
-    int prevHeight = pindexPrev->nHeight;
-
-    // get stake input pindex
-    CBlockIndex* pindexFrom = stakeInput->GetIndexFrom();
-    if (!pindexFrom || pindexFrom->nHeight < 1) return error("%s : no pindexfrom", __func__);
-
-    const uint32_t nTimeBlockFrom = pindexFrom->nTime;
-    const int nHeightBlockFrom = pindexFrom->nHeight;
-
-    // check for maturity (min age/depth) requirements
-    if (!HasStakeMinAgeOrDepth(prevHeight + 1, nTimeTx, nHeightBlockFrom, nTimeBlockFrom))
-        return error("%s : min age violation - height=%d - nTimeTx=%d, nTimeBlockFrom=%d, nHeightBlockFrom=%d",
-                         __func__, prevHeight + 1, nTimeTx, nTimeBlockFrom, nHeightBlockFrom);
-
-    // iterate the hashing
-    bool fSuccess = false;
-    const unsigned int nHashDrift = 60;
-    const unsigned int nFutureTimeDriftPoS = 180;
-    unsigned int nTryTime = nTimeTx - 1;
-    // iterate from nTimeTx up to nTimeTx + nHashDrift
-    // but not after the max allowed future blocktime drift (3 minutes for PoS)
-    const unsigned int maxTime = std::min(nTimeTx + nHashDrift, (uint32_t)GetAdjustedTime() + nFutureTimeDriftPoS);
+    if (nThreads <= 0)
+        nThreads = GetNumCores();
+    nThreads = std::min(nThreads, MAX_STAKING_THREADS);
+
+    // A single thread searches on the calling thread
+    if (nThreads > 1) {
+        workerPool.resize(nThreads);
+        RenameThreadPool(workerPool, "ion-stake-worker");
+    }
+}
 
-    while (nTryTime < maxTime)
-    {
-        //new block came in, move on
-        if (chainActive.Height() != prevHeight)
-            break;
+void CStakingManager::StopWorkers()
+{
+    workerPool.clear_queue();
+    workerPool.stop(true);
+}
 
-        ++nTryTime;
+// Scans the (input x timestamp) grid for a kernel meeting the target, starting at input nStart. Inputs are handed
+// out to the workers in order, so the result is the same as checking them one after another: the first input with
+// a valid kernel, at its earliest valid time. Returns -1 if there is none or the chain tip changed during the search.
+int CStakingManager::FindStakeKernel(const CBlockIndex* pindexPrev, const std::vector<CStakeKernel>& vKernels, size_t nStart, unsigned int nTimeFrom, unsigned int nTimeTo, unsigned int& nTimeTx, uint256& hashProofOfStake)
+{
+    if (nStart >= vKernels.size())
+        return -1;
+
+    const int prevHeight = pindexPrev->nHeight;
+    std::atomic<size_t> nNext{nStart};
+    std::atomic<size_t> nFound{vKernels.size()};
+    std::vector<unsigned int> vTimeFound(vKernels.size());
+    std::vector<uint256> vHashFound(vKernels.size());
+
+    auto search = [&](int threadId) {
+        for (size_t i = nNext++; i < nFound; i = nNext++) {
+            //new block came in, move on
+            if (chainActive.Height() != prevHeight || ShutdownRequested())
+                return;
+
+            for (unsigned int nTryTime = nTimeFrom; nTryTime <= nTimeTo; nTryTime++) {
+                // if stake hash does not meet the target then continue to next iteration
+                uint256 hash;
+                if (!vKernels[i].CheckHash(nTryTime, hash))
+                    continue;
 
-        // if stake hash does not meet the target then continue to next iteration
-        if (!CheckStakeKernelHash(pindexPrev, nBits, stakeInput, nTryTime, hashProofOfStake))
-            continue;
+                vTimeFound[i] = nTryTime;
+                vHashFound[i] = hash;
+                size_t nPrev = nFound;
+                while (i < nPrev && !nFound.compare_exchange_weak(nPrev, i)) {}
+                break;
+            }
+        }
+    };
 
-        // if we made it this far, then we have successfully found a valid kernel hash
-        fSuccess = true;
-        nTimeTx = nTryTime;
-        break;
+    const size_t nWorkers = std::min((size_t)workerPool.size(), vKernels.size() - nStart);
+    if (nWorkers > 1) {
+        std::vector<std::future<void> > futures;
+        for (size_t i = 0; i < nWorkers; i++) {
+            futures.emplace_back(workerPool.push(search));
+        }
+        for (auto& f : futures) {
+            f.get();
+        }
+    } else {
+        search(0);
     }
 
-    mapHashedBlocks.clear();
-    mapHashedBlocks[chainActive.Tip()->nHeight] = GetTime(); //store a time stamp of when we last hashed on this block
-    return fSuccess;
+    if (chainActive.Height() != prevHeight || nFound == vKernels.size())
+        return -1;
+
+    nTimeTx = vTimeFound[nFound];
+    hashProofOfStake = vHashFound[nFound];
+    return (int)nFound;
 }
 
 bool CStakingManager::CreateCoinStake(const CBlockIndex* pindexPrev, std::shared_ptr<CMutableTransaction>& coinstakeTx, std::shared_ptr<CStakeInput>& coinstakeInput) {
@@ -169,7 +326,6 @@ bool CStakingManager::CreateCoinStake(const CBlockIndex* pindexPrev, std::shared
         }
     }
 
-    CScript scriptPubKeyKernel;
     bool fKernelFound = false;
     int nAttempts = 0;
 
@@ -180,50 +336,94 @@ bool CStakingManager::CreateCoinStake(const CBlockIndex* pindexPrev, std::shared
         nTxNewTime = pindexPrev->nTime;
     }
 
+    // iterate from nTxNewTime up to nTxNewTime + nHashDrift
+    // but not after the max allowed future blocktime drift (3 minutes for PoS)
+    const unsigned int nHashDrift = 60;
+    const unsigned int nFutureTimeDriftPoS = 180;
+    const unsigned int nMaxTime = std::min(nTxNewTime + nHashDrift, (uint32_t)GetAdjustedTime() + nFutureTimeDriftPoS);
+
+    unsigned int stakeNBits = GetNextWorkRequired(pindexPrev, Params().GetConsensus(), false);
+
+    // Precompute the constant part of the kernel of every input, the search below only hashes timestamps
+    std::vector<std::unique_ptr<CStakeInput> > vInputs;
+    std::vector<CStakeKernel> vKernels;
     for (std::unique_ptr<CStakeInput>& stakeInput : listInputs) {
+        // get stake input pindex
+        CBlockIndex* pindexFrom = stakeInput->GetIndexFrom();
+        if (!pindexFrom || pindexFrom->nHeight < 1) {
+            LogPrint(BCLog::STAKING, "%s : no pindexfrom\n", __func__);
+            continue;
+        }
+
+        // check for maturity (min age/depth) requirements
+        if (!HasStakeMinAgeOrDepth(pindexPrev->nHeight + 1, nTxNewTime, pindexFrom->nHeight, pindexFrom->nTime)) {
+            LogPrint(BCLog::STAKING, "%s : min age violation - height=%d - nTimeTx=%d, nTimeBlockFrom=%d, nHeightBlockFrom=%d\n",
+                     __func__, pindexPrev->nHeight + 1, nTxNewTime, pindexFrom->nTime, pindexFrom->nHeight);
+            continue;
+        }
+
+        CStakeKernel kernel;
+        if (!kernel.Init(pindexPrev, stakeNBits, stakeInput.get()))
+            continue;
+
+        vInputs.emplace_back(std::move(stakeInput));
+        vKernels.emplace_back(kernel);
+    }
+
+    size_t nNext = 0;
+    while (nNext < vKernels.size()) {
         // Make sure the wallet is unlocked and shutdown hasn't been requested
         if (pwallet->IsLocked(true) || ShutdownRequested())
             return false;
 
         boost::this_thread::interruption_point();
 
-        unsigned int stakeNBits = GetNextWorkRequired(pindexPrev, Params().GetConsensus(), false);
+        unsigned int nTimeTx = 0;
         uint256 hashProofOfStake = uint256();
-        nAttempts++;
-        //iterates each utxo inside of CheckStakeKernelHash()
-        if (Stake(pindexPrev, stakeInput.get(), stakeNBits, nTxNewTime, hashProofOfStake)) {
-            coinstakeTx->nTime = nTxNewTime;
-
-            // Found a kernel
-            LogPrint(BCLog::STAKING, "CreateCoinStake : kernel found\n");
-
-            // Stake output value is set to stake input value.
-            // Adding stake rewards and potentially splitting outputs is performed in BlockAssembler::CreateNewBlock()
-            if (!stakeInput->CreateTxOuts(pwallet, coinstakeTx->vout, stakeInput->GetValue())) {
-                LogPrint(BCLog::STAKING, "%s : failed to get scriptPubKey\n", __func__);
-                return false;
-            }
+        int nFound = FindStakeKernel(pindexPrev, vKernels, nNext, nTxNewTime, nMaxTime, nTimeTx, hashProofOfStake);
 
-            // Limit size
-            unsigned int nBytes = ::GetSerializeSize(*coinstakeTx, SER_NETWORK, CTransaction::CURRENT_VERSION);
-            if (nBytes >= MAX_STANDARD_TX_SIZE)
-                return error("CreateCoinStake : exceeded coinstake size limit");
-
-            {
-                uint256 hashTxOut = coinstakeTx->GetHash();
-                CTxIn in;
-                if (!stakeInput->CreateTxIn(pwallet, in, hashTxOut)) {
-                    LogPrint(BCLog::STAKING, "%s : failed to create TxIn\n", __func__);
-                    coinstakeTx->vin.clear();
-                    coinstakeTx->vout.clear();
-                    continue;
-                }
-                coinstakeTx->vin.emplace_back(in);
-            }
-            coinstakeInput = std::move(stakeInput);
-            fKernelFound = true;
+        mapHashedBlocks.clear();
+        mapHashedBlocks[chainActive.Tip()->nHeight] = GetTime(); //store a time stamp of when we last hashed on this block
+
+        if (nFound < 0) {
+            nAttempts += vKernels.size() - nNext;
             break;
         }
+        nAttempts += nFound + 1 - nNext;
+        nNext = nFound + 1;
+
+        std::unique_ptr<CStakeInput>& stakeInput = vInputs[nFound];
+        coinstakeTx->nTime = nTimeTx;
+
+        // Found a kernel
+        LogPrint(BCLog::STAKING, "CreateCoinStake : kernel found\n");
+
+        // Stake output value is set to stake input value.
+        // Adding stake rewards and potentially splitting outputs is performed in BlockAssembler::CreateNewBlock()
+        if (!stakeInput->CreateTxOuts(pwallet, coinstakeTx->vout, stakeInput->GetValue())) {
+            LogPrint(BCLog::STAKING, "%s : failed to get scriptPubKey\n", __func__);
+            return false;
+        }
+
+        // Limit size
+        unsigned int nBytes = ::GetSerializeSize(*coinstakeTx, SER_NETWORK, CTransaction::CURRENT_VERSION);
+        if (nBytes >= MAX_STANDARD_TX_SIZE)
+            return error("CreateCoinStake : exceeded coinstake size limit");
+
+        {
+            uint256 hashTxOut = coinstakeTx->GetHash();
+            CTxIn in;
+            if (!stakeInput->CreateTxIn(pwallet, in, hashTxOut)) {
+                LogPrint(BCLog::STAKING, "%s : failed to create TxIn\n", __func__);
+                coinstakeTx->vin.clear();
+                coinstakeTx->vout.clear();
+                continue;
+            }
+            coinstakeTx->vin.emplace_back(in);
+        }
+        coinstakeInput = std::move(stakeInput);
+        fKernelFound = true;
+        break;
     }
     LogPrint(BCLog::STAKING, "%s: attempted staking %d times\n", __func__, nAttempts);
 
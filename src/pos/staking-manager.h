@@ -6,21 +6,43 @@
 #define STAKING_CLIENT_H
 
 #include "amount.h"
+#include "ctpl.h"
+#include "primitives/transaction.h"
 #include "script/script.h"
 #include "sync.h"
 
 #include <univalue.h>
 
+#include <boost/signals2/connection.hpp>
+
 class CBlockIndex;
 class CConnman;
 class CMutableTransaction;
 class CStakeInput;
+class CStakeKernel;
 class CStakingManager;
 class CWallet;
 class uint256;
 
 extern std::shared_ptr<CStakingManager> stakingManager;
 
+/** Default for -stakingthreads, 0 uses one thread per core */
+static const int DEFAULT_STAKING_THREADS = 1;
+static const int MAX_STAKING_THREADS = 16;
+
+/** A wallet output that can stake once the chain reaches nStakeHeight */
+struct CStakeCandidate
+{
+    CTransactionRef tx;
+    unsigned int n;
+    int nHeight;
+    uint32_t nTime;
+    // First block height at which a coinbase, coinstake or token authority output is mature
+    int nMaturityHeight;
+    // First block height at which the output is mature and deep enough to stake
+    int nStakeHeight;
+};
+
 class CStakingManager
 {
 public:
@@ -40,8 +62,28 @@ private:
     unsigned int nExtraNonce;
     const unsigned int nHashInterval;
 
+    // Stakeable outputs of the wallet ordered by nStakeHeight. Kept up to date from wallet transaction
+    // notifications, so that a staking round only looks at transactions that changed since the last one.
+    CCriticalSection cs_stakeCandidates;
+    std::map<COutPoint, CStakeCandidate> mapStakeCandidates;
+    std::set<std::pair<int, COutPoint> > setStakeCandidatesByHeight;
+    std::set<uint256> setPendingStakeTxes;
+    bool fStakeCandidatesLoaded{false};
+    boost::signals2::connection connNotifyTransactionChanged;
+
+    void NotifyTransactionChanged(const uint256& hashTx);
+    void EraseStakeCandidates(const uint256& hashTx);
+    void AddStakeCandidates(const uint256& hashTx);
+    void UpdateStakeCandidates();
+
+    // Workers scanning stake kernels of different inputs in parallel
+    ctpl::thread_pool workerPool;
+
+    int FindStakeKernel(const CBlockIndex* pindexPrev, const std::vector<CStakeKernel>& vKernels, size_t nStart, unsigned int nTimeFrom, unsigned int nTimeTo, unsigned int& nTimeTx, uint256& hashProofOfStake);
+
 public:
     CStakingManager(CWallet * const pwalletIn = nullptr);
+    ~CStakingManager();
 
     bool fEnableStaking;
     bool fEnableIONStaking;
@@ -50,7 +92,8 @@ public:
     bool MintableCoins();
     bool SelectStakeCoins(std::list<std::unique_ptr<CStakeInput> >& listInputs, CAmount nTargetAmount, int blockHeight);
     bool CreateCoinStake(const CBlockIndex* pindexPrev, std::shared_ptr<CMutableTransaction>& coinstakeTx, std::shared_ptr<CStakeInput>& coinstakeInput);
-    bool Stake(const CBlockIndex* pindexPrev, CStakeInput* stakeInput, unsigned int nBits, unsigned int& nTimeTx, uint256& hashProofOfStake);
+    void StartWorkers(int nThreads);
+    void StopWorkers();
     bool IsStaking();
 
     void UpdatedBlockTip(const CBlockIndex* pindex);
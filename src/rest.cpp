@@ -12,6 +12,7 @@
 #include "validation.h"
 #include "httpserver.h"
 #include "rpc/blockchain.h"
+#include "rpc/jsonwriter.h"
 #include "rpc/server.h"
 #include "streams.h"
 #include "sync.h"
@@ -243,10 +244,19 @@ static bool rest_block(HTTPRequest* req,
     }
 
     case RF_JSON: {
-        UniValue objBlock = blockToJSON(block, pblockindex, showTxDetails);
-        std::string strJSON = objBlock.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        req->StartReplyChunked(HTTP_OK);
+        CJSONWriter writer([req](const std::string& strChunk) { return req->WriteReplyChunk(strChunk); });
+        try {
+            blockToJSON(writer, block, pblockindex, showTxDetails);
+            writer.Flush();
+        } catch (const CJSONWriterClosed&) {
+            // the client is gone, don't produce the rest of the reply
+            req->EndReplyChunked();
+            return false;
+        }
+        req->WriteReplyChunk("\n");
+        req->EndReplyChunked();
         return true;
     }
 
@@ -332,11 +342,19 @@ static bool rest_mempool_contents(HTTPRequest* req, const std::string& strURIPar
 
     switch (rf) {
     case RF_JSON: {
-        UniValue mempoolObject = mempoolToJSON(true);
-
-        std::string strJSON = mempoolObject.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        req->StartReplyChunked(HTTP_OK);
+        CJSONWriter writer([req](const std::string& strChunk) { return req->WriteReplyChunk(strChunk); });
+        try {
+            mempoolToJSON(writer, true);
+            writer.Flush();
+        } catch (const CJSONWriterClosed&) {
+            // the client is gone, don't produce the rest of the reply
+            req->EndReplyChunked();
+            return false;
+        }
+        req->WriteReplyChunk("\n");
+        req->EndReplyChunked();
         return true;
     }
     default: {
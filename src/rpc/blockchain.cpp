@@ -23,10 +23,12 @@
 #include "policy/feerate.h"
 #include "policy/policy.h"
 #include "primitives/transaction.h"
+#include "rpc/jsonwriter.h"
 #include "rpc/server.h"
 #include "script/tokengroup.h"
 #include "streams.h"
 #include "sync.h"
+#include "tokens/tokendb.h"
 #include "tokens/tokengroupmanager.h"
 #include "txdb.h"
 #include "txmempool.h"
@@ -125,9 +127,10 @@ UniValue blockheaderToJSON(const CBlockIndex* blockindex)
     return result;
 }
 
-UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool txDetails)
+// Fields of the block description before and after its transactions, requires cs_main
+static void blockFieldsToJSON(const CBlock& block, const CBlockIndex* blockindex, UniValue& result, UniValue& trailer, bool& chainLock)
 {
-    UniValue result(UniValue::VOBJ);
+    AssertLockHeld(cs_main);
     result.push_back(Pair("hash", blockindex->GetBlockHash().GetHex()));
     int confirmations = -1;
     // Only report confirmations if the block is on the main chain
@@ -139,49 +142,86 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool tx
     result.push_back(Pair("version", block.nVersion));
     result.push_back(Pair("versionHex", strprintf("%08x", block.nVersion)));
     result.push_back(Pair("merkleroot", block.hashMerkleRoot.GetHex()));
-    bool chainLock = llmq::chainLocksHandler->HasChainLock(blockindex->nHeight, blockindex->GetBlockHash());
-    UniValue txs(UniValue::VARR);
-    for(const auto& tx : block.vtx)
-    {
-        if(txDetails)
-        {
-            UniValue objTx(UniValue::VOBJ);
-            TxToUniv(*tx, uint256(), objTx);
-            bool fLocked = llmq::quorumInstantSendManager->IsLocked(tx->GetHash());
-            objTx.push_back(Pair("instantlock", fLocked || chainLock));
-            objTx.push_back(Pair("instantlock_internal", fLocked));
-            txs.push_back(objTx);
-        }
-        else
-            txs.push_back(tx->GetHash().GetHex());
-    }
-    result.push_back(Pair("tx", txs));
+    chainLock = llmq::chainLocksHandler->HasChainLock(blockindex->nHeight, blockindex->GetBlockHash());
+
     if (!block.vtx[0]->vExtraPayload.empty()) {
         CCbTx cbTx;
         if (GetTxPayload(block.vtx[0]->vExtraPayload, cbTx)) {
             UniValue cbTxObj;
             cbTx.ToJson(cbTxObj);
-            result.push_back(Pair("cbTx", cbTxObj));
+            trailer.push_back(Pair("cbTx", cbTxObj));
         }
     }
-    result.push_back(Pair("time", block.GetBlockTime()));
-    result.push_back(Pair("mediantime", (int64_t)blockindex->GetMedianTimePast()));
-    result.push_back(Pair("nonce", (uint64_t)block.nNonce));
-    result.push_back(Pair("bits", strprintf("%08x", block.nBits)));
-    result.push_back(Pair("difficulty", GetDifficulty(blockindex)));
-    result.push_back(Pair("chainwork", blockindex->nChainWork.GetHex()));
+    trailer.push_back(Pair("time", block.GetBlockTime()));
+    trailer.push_back(Pair("mediantime", (int64_t)blockindex->GetMedianTimePast()));
+    trailer.push_back(Pair("nonce", (uint64_t)block.nNonce));
+    trailer.push_back(Pair("bits", strprintf("%08x", block.nBits)));
+    trailer.push_back(Pair("difficulty", GetDifficulty(blockindex)));
+    trailer.push_back(Pair("chainwork", blockindex->nChainWork.GetHex()));
 
     if (blockindex->pprev)
-        result.push_back(Pair("previousblockhash", blockindex->pprev->GetBlockHash().GetHex()));
+        trailer.push_back(Pair("previousblockhash", blockindex->pprev->GetBlockHash().GetHex()));
     CBlockIndex *pnext = chainActive.Next(blockindex);
     if (pnext)
-        result.push_back(Pair("nextblockhash", pnext->GetBlockHash().GetHex()));
+        trailer.push_back(Pair("nextblockhash", pnext->GetBlockHash().GetHex()));
 
-    result.push_back(Pair("chainlock", chainLock));
+    trailer.push_back(Pair("chainlock", chainLock));
+}
+
+static UniValue blockTxToJSON(const CTransaction& tx, bool txDetails, bool chainLock)
+{
+    if (!txDetails)
+        return tx.GetHash().GetHex();
+
+    UniValue objTx(UniValue::VOBJ);
+    TxToUniv(tx, uint256(), objTx);
+    bool fLocked = llmq::quorumInstantSendManager->IsLocked(tx.GetHash());
+    objTx.push_back(Pair("instantlock", fLocked || chainLock));
+    objTx.push_back(Pair("instantlock_internal", fLocked));
+    return objTx;
+}
+
+UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool txDetails)
+{
+    UniValue result(UniValue::VOBJ);
+    UniValue trailer(UniValue::VOBJ);
+    bool chainLock;
+    {
+        LOCK(cs_main);
+        blockFieldsToJSON(block, blockindex, result, trailer, chainLock);
+    }
+
+    UniValue txs(UniValue::VARR);
+    for(const auto& tx : block.vtx)
+        txs.push_back(blockTxToJSON(*tx, txDetails, chainLock));
+    result.push_back(Pair("tx", txs));
+    result.pushKVs(trailer);
 
     return result;
 }
 
+void blockToJSON(CJSONWriter& writer, const CBlock& block, const CBlockIndex* blockindex, bool txDetails)
+{
+    UniValue result(UniValue::VOBJ);
+    UniValue trailer(UniValue::VOBJ);
+    bool chainLock;
+    {
+        LOCK(cs_main);
+        blockFieldsToJSON(block, blockindex, result, trailer, chainLock);
+    }
+
+    // Only one transaction is held as UniValue at a time
+    writer.BeginObject();
+    writer.Fields(result);
+    writer.Key("tx");
+    writer.BeginArray();
+    for(const auto& tx : block.vtx)
+        writer.Value(blockTxToJSON(*tx, txDetails, chainLock));
+    writer.EndArray();
+    writer.Fields(trailer);
+    writer.EndObject();
+}
+
 UniValue getblockcount(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 0)
@@ -473,6 +513,44 @@ UniValue mempoolToJSON(bool fVerbose)
     }
 }
 
+void mempoolToJSON(CJSONWriter& writer, bool fVerbose)
+{
+    if (fVerbose)
+    {
+        // Writing may block on a slow client, so the entries are taken while mempool.cs is held
+        // and written after it was released
+        std::vector<std::pair<std::string, std::string> > vEntries;
+        {
+            LOCK(mempool.cs);
+            vEntries.reserve(mempool.mapTx.size());
+            for (const CTxMemPoolEntry& e : mempool.mapTx)
+            {
+                UniValue info(UniValue::VOBJ);
+                entryToJSON(info, e);
+                vEntries.emplace_back(e.GetTx().GetHash().ToString(), info.write());
+            }
+        }
+
+        writer.BeginObject();
+        for (const auto& entry : vEntries)
+        {
+            writer.Key(entry.first);
+            writer.RawValue(entry.second);
+        }
+        writer.EndObject();
+    }
+    else
+    {
+        std::vector<uint256> vtxid;
+        mempool.queryHashes(vtxid);
+
+        writer.BeginArray();
+        for (const uint256& hash : vtxid)
+            writer.Value(hash.ToString());
+        writer.EndArray();
+    }
+}
+
 UniValue getrawmempool(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() > 1)
@@ -502,6 +580,11 @@ UniValue getrawmempool(const JSONRPCRequest& request)
     if (!request.params[0].isNull())
         fVerbose = request.params[0].get_bool();
 
+    if (request.resultWriter) {
+        mempoolToJSON(*request.resultWriter, fVerbose);
+        return NullUniValue;
+    }
+
     return mempoolToJSON(fVerbose);
 }
 
@@ -1023,8 +1106,6 @@ UniValue getblock(const JSONRPCRequest& request)
             + HelpExampleRpc("getblock", "\"00000000000fd08c2fb661d2fcb0d49abb3a91e5f27082ce64feed3b4dede2e2\"")
         );
 
-    LOCK(cs_main);
-
     std::string strHash = request.params[0].get_str();
     uint256 hash(uint256S(strHash));
 
@@ -1036,11 +1117,16 @@ UniValue getblock(const JSONRPCRequest& request)
             verbosity = request.params[1].get_bool() ? 1 : 0;
     }
 
-    if (mapBlockIndex.count(hash) == 0)
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+    CBlockIndex* pblockindex;
+    CBlock block;
+    {
+        LOCK(cs_main);
+        if (mapBlockIndex.count(hash) == 0)
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
 
-    CBlockIndex* pblockindex = mapBlockIndex[hash];
-    const CBlock block = GetBlockChecked(pblockindex);
+        pblockindex = mapBlockIndex[hash];
+        block = GetBlockChecked(pblockindex);
+    }
 
     if (verbosity <= 0)
     {
@@ -1050,6 +1136,12 @@ UniValue getblock(const JSONRPCRequest& request)
         return strHex;
     }
 
+    // cs_main is only held while the block fields are written, not the transactions
+    if (request.resultWriter) {
+        blockToJSON(*request.resultWriter, block, pblockindex, verbosity >= 2);
+        return NullUniValue;
+    }
+
     return blockToJSON(block, pblockindex, verbosity >= 2);
 }
 
@@ -2482,6 +2574,7 @@ UniValue scantokens(const JSONRPCRequest& request)
             "scantokens <action> ( <tokengroupid> )\n"
 
             "\nScans the unspent transaction output set for possible entries that belong to a specified token group.\n"
+            "When the token index is enabled (-tokenindex) the unspent outputs are read from the index instead.\n"
             "\nArguments:\n"
             "1. \"action\"                     (string, required) The action to execute\n"
             "                                      \"start\" for starting a scan\n"
@@ -2554,14 +2647,25 @@ UniValue scantokens(const JSONRPCRequest& request)
         g_should_abort_scan = false;
         g_scan_progress = 0;
         int64_t count = 0;
-        std::unique_ptr<CCoinsViewCursor> pcursor;
-        {
-            LOCK(cs_main);
-            FlushStateToDisk();
-            pcursor = std::unique_ptr<CCoinsViewCursor>(pcoinsdbview->Cursor());
-            assert(pcursor);
+        bool res;
+        if (fTokenIndex) {
+            std::vector<std::pair<CTokenIndexKey, CTokenIndexValue> > tokenIndex;
+            res = pTokenDB->ReadTokenIndex(needle, tokenIndex);
+            for (const auto& entry : tokenIndex) {
+                coins.emplace(COutPoint(entry.first.txhash, entry.first.index), Coin(CTxOut(entry.second.satoshis, entry.second.script), entry.second.blockHeight, false, false));
+            }
+            count = tokenIndex.size();
+            g_scan_progress = 100;
+        } else {
+            std::unique_ptr<CCoinsViewCursor> pcursor;
+            {
+                LOCK(cs_main);
+                FlushStateToDisk();
+                pcursor = std::unique_ptr<CCoinsViewCursor>(pcoinsdbview->Cursor());
+                assert(pcursor);
+            }
+            res = FindTokenGroupID(g_scan_progress, g_should_abort_scan, count, pcursor.get(), needle, coins);
         }
-        bool res = FindTokenGroupID(g_scan_progress, g_should_abort_scan, count, pcursor.get(), needle, coins);
         result.pushKV("success", res);
         result.pushKV("searched_items", count);
 
@@ -7,6 +7,7 @@
 
 class CBlock;
 class CBlockIndex;
+class CJSONWriter;
 class UniValue;
 
 /**
@@ -23,12 +24,16 @@ void RPCNotifyBlockChange(bool ibd, const CBlockIndex *);
 
 /** Block description to JSON */
 UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool txDetails = false);
+/** Block description written to a streaming JSON writer, without building it as one UniValue */
+void blockToJSON(CJSONWriter& writer, const CBlock& block, const CBlockIndex* blockindex, bool txDetails = false);
 
 /** Mempool information to JSON */
 UniValue mempoolInfoToJSON();
 
 /** Mempool to JSON */
 UniValue mempoolToJSON(bool fVerbose = false);
+/** Mempool written to a streaming JSON writer, without building it as one UniValue */
+void mempoolToJSON(CJSONWriter& writer, bool fVerbose = false);
 
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex* blockindex);
@@ -0,0 +1,101 @@
+// Copyright (c) 2020 The Ion Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rpc/jsonwriter.h"
+
+#include <assert.h>
+
+CJSONWriter::CJSONWriter(const std::function<bool(const std::string&)>& sinkIn, size_t nFlushSizeIn) :
+    sink(sinkIn), nFlushSize(nFlushSizeIn), fAfterKey(false), fEmpty(true)
+{
+}
+
+void CJSONWriter::Write(const std::string& str)
+{
+    fEmpty = false;
+    strBuffer += str;
+    if (strBuffer.size() >= nFlushSize)
+        Flush();
+}
+
+void CJSONWriter::BeginElement()
+{
+    if (fAfterKey) {
+        fAfterKey = false;
+        return;
+    }
+    if (vFirstElement.empty())
+        return;
+    if (!vFirstElement.back())
+        Write(",");
+    vFirstElement.back() = false;
+}
+
+void CJSONWriter::BeginObject()
+{
+    BeginElement();
+    Write("{");
+    vFirstElement.push_back(true);
+}
+
+void CJSONWriter::EndObject()
+{
+    assert(!vFirstElement.empty() && !fAfterKey);
+    vFirstElement.pop_back();
+    Write("}");
+}
+
+void CJSONWriter::BeginArray()
+{
+    BeginElement();
+    Write("[");
+    vFirstElement.push_back(true);
+}
+
+void CJSONWriter::EndArray()
+{
+    assert(!vFirstElement.empty() && !fAfterKey);
+    vFirstElement.pop_back();
+    Write("]");
+}
+
+void CJSONWriter::Key(const std::string& key)
+{
+    assert(!vFirstElement.empty() && !fAfterKey);
+    BeginElement();
+    Write(UniValue(key).write() + ":");
+    fAfterKey = true;
+}
+
+void CJSONWriter::Value(const UniValue& value)
+{
+    BeginElement();
+    Write(value.write());
+}
+
+void CJSONWriter::RawValue(const std::string& json)
+{
+    BeginElement();
+    Write(json);
+}
+
+void CJSONWriter::Fields(const UniValue& obj)
+{
+    const std::vector<std::string>& keys = obj.getKeys();
+    const std::vector<UniValue>& values = obj.getValues();
+    for (size_t i = 0; i < keys.size(); i++) {
+        Key(keys[i]);
+        Value(values[i]);
+    }
+}
+
+void CJSONWriter::Flush()
+{
+    if (strBuffer.empty())
+        return;
+    bool fAccepted = sink(strBuffer);
+    strBuffer.clear();
+    if (!fAccepted)
+        throw CJSONWriterClosed();
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2020 The Ion Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef ION_RPC_JSONWRITER_H
+#define ION_RPC_JSONWRITER_H
+
+#include <univalue.h>
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/** Size at which buffered output is handed to the sink */
+static const size_t DEFAULT_JSON_WRITER_FLUSH_SIZE = 64 * 1024;
+
+/** Thrown by CJSONWriter when its sink no longer accepts output */
+class CJSONWriterClosed : public std::runtime_error
+{
+public:
+    CJSONWriterClosed() : std::runtime_error("JSON output was closed") {}
+};
+
+/**
+ * Writes a JSON document incrementally instead of building it as one UniValue tree. Large
+ * containers are opened and closed explicitly and their elements written one at a time, each
+ * element as a small UniValue. Output is buffered and passed to the sink in chunks.
+ * The sink returns false once its receiver is gone, the writer then throws CJSONWriterClosed
+ * so that the producer stops instead of serializing the rest of the document.
+ */
+class CJSONWriter
+{
+private:
+    std::function<bool(const std::string&)> sink;
+    size_t nFlushSize;
+    std::string strBuffer;
+    // one entry per open object or array, true until its first element was written
+    std::vector<bool> vFirstElement;
+    bool fAfterKey;
+    bool fEmpty;
+
+    void Write(const std::string& str);
+    void BeginElement();
+
+public:
+    CJSONWriter(const std::function<bool(const std::string&)>& sinkIn, size_t nFlushSizeIn = DEFAULT_JSON_WRITER_FLUSH_SIZE);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+
+    /** Write the key of the next value of the current object */
+    void Key(const std::string& key);
+    void Value(const UniValue& value);
+    /** Write a value that is already serialized JSON */
+    void RawValue(const std::string& json);
+    /** Write all key/value pairs of obj into the current object */
+    void Fields(const UniValue& obj);
+
+    /** Pass buffered output to the sink, throws CJSONWriterClosed if the sink refused it */
+    void Flush();
+    /** Whether nothing has been written yet */
+    bool IsEmpty() const { return fEmpty; }
+};
+
+#endif // ION_RPC_JSONWRITER_H
@@ -702,6 +702,81 @@ bool getAddressesFromParams(const UniValue& params, std::vector<std::pair<uint16
     return true;
 }
 
+bool getAddressPageFromParams(const UniValue& params, size_t& nLimit, std::string& strCursor)
+{
+    if (!params[0].isObject()) {
+        return false;
+    }
+    UniValue limitValue = find_value(params[0].get_obj(), "limit");
+    if (limitValue.isNull()) {
+        return false;
+    }
+    if (!limitValue.isNum() || limitValue.get_int() <= 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Limit is expected to be a positive number");
+    }
+    nLimit = limitValue.get_int();
+
+    UniValue cursorValue = find_value(params[0].get_obj(), "cursor");
+    if (cursorValue.isStr()) {
+        strCursor = cursorValue.get_str();
+    } else if (!cursorValue.isNull()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Cursor is expected to be a string");
+    }
+    return true;
+}
+
+/**
+ * Reads the address index entries of at most nLimit transactions. The addresses are read one after the other,
+ * a page starts at the entry encoded in strCursor and strNextCursor is set to the entry the next page starts at.
+ */
+void getAddressIndexPage(const std::vector<std::pair<uint160, int> >& addresses, int start, int end,
+                         size_t nLimit, const std::string& strCursor,
+                         std::vector<std::pair<CAddressIndexKey, CAmount> >& addressIndex, std::string& strNextCursor)
+{
+    // like GetAddressIndex, the height range is only used when both ends are given
+    if (start <= 0 || end <= 0) {
+        start = end = 0;
+    }
+
+    size_t nFirstAddress = 0;
+    CAddressIndexKey startKey;
+    if (!strCursor.empty()) {
+        if (!IsHex(strCursor)) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+        }
+        try {
+            CDataStream ss(ParseHex(strCursor), SER_DISK, CLIENT_VERSION);
+            ss >> startKey;
+        } catch (const std::exception&) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+        }
+        while (nFirstAddress < addresses.size() &&
+               (addresses[nFirstAddress].first != startKey.hashBytes || addresses[nFirstAddress].second != (int)startKey.type)) {
+            nFirstAddress++;
+        }
+        if (nFirstAddress == addresses.size()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Cursor does not belong to the given addresses");
+        }
+    }
+
+    for (size_t i = nFirstAddress; i < addresses.size(); i++) {
+        if (strCursor.empty() || i != nFirstAddress) {
+            startKey = CAddressIndexKey(addresses[i].second, addresses[i].first, start, 0, uint256(), 0, false);
+        }
+        CAddressIndexKey nextKey;
+        bool fMore;
+        if (!GetAddressIndexPage(startKey, end, nLimit, addressIndex, nextKey, fMore)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+        }
+        if (fMore) {
+            CDataStream ss(SER_DISK, CLIENT_VERSION);
+            ss << nextKey;
+            strNextCursor = HexStr(ss.begin(), ss.end());
+            return;
+        }
+    }
+}
+
 bool heightSort(std::pair<CAddressUnspentKey, CAddressUnspentValue> a,
                 std::pair<CAddressUnspentKey, CAddressUnspentValue> b) {
     return a.second.blockHeight < b.second.blockHeight;
@@ -865,6 +940,9 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
             "    ]\n"
             "  \"start\" (number) The start block height\n"
             "  \"end\" (number) The end block height\n"
+            "  \"limit\" (number, optional) Return the deltas of at most this many transactions per call,\n"
+            "            the addresses are returned one after the other\n"
+            "  \"cursor\" (string, optional) The cursor returned by the previous call, to continue after it\n"
             "}\n"
             "\nResult:\n"
             "[\n"
@@ -877,8 +955,14 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
             "    \"address\"  (string) The base58check encoded address\n"
             "  }\n"
             "]\n"
+            "\nResult (with limit):\n"
+            "{\n"
+            "  \"deltas\"  (array) The deltas as above\n"
+            "  \"cursor\"  (string) Pass as cursor to get the next page, missing on the last page\n"
+            "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"idFcVh28YpxoCdJhiVjmsUn1Cq9rpJ6KP6\"]}'")
+            + HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"idFcVh28YpxoCdJhiVjmsUn1Cq9rpJ6KP6\"], \"limit\": 1000}'")
             + HelpExampleRpc("getaddressdeltas", "{\"addresses\": [\"idFcVh28YpxoCdJhiVjmsUn1Cq9rpJ6KP6\"]}")
         );
 
@@ -905,14 +989,23 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
 
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
-    for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (start > 0 && end > 0) {
-            if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-            }
-        } else {
-            if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+    size_t nLimit = 0;
+    std::string strCursor;
+    std::string strNextCursor;
+    bool fPaged = getAddressPageFromParams(request.params, nLimit, strCursor);
+
+    if (fPaged) {
+        getAddressIndexPage(addresses, start, end, nLimit, strCursor, addressIndex, strNextCursor);
+    } else {
+        for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+            if (start > 0 && end > 0) {
+                if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+                }
+            } else {
+                if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+                }
             }
         }
     }
@@ -935,6 +1028,15 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
         result.push_back(delta);
     }
 
+    if (fPaged) {
+        UniValue page(UniValue::VOBJ);
+        page.push_back(Pair("deltas", result));
+        if (!strNextCursor.empty()) {
+            page.push_back(Pair("cursor", strNextCursor));
+        }
+        return page;
+    }
+
     return result;
 }
 
@@ -956,6 +1058,8 @@ UniValue getaddressbalance(const JSONRPCRequest& request)
             "{\n"
             "  \"balance\"  (string) The current balance in duffs\n"
             "  \"received\"  (string) The total number of duffs received (including change)\n"
+            "  \"txcount\"  (number) The number of transactions of the addresses, counted once per address\n"
+            "  \"lastheight\"  (number) The height of the last block with a transaction of the addresses\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getaddressbalance", "'{\"addresses\": [\"idFcVh28YpxoCdJhiVjmsUn1Cq9rpJ6KP6\"]}'")
@@ -968,27 +1072,27 @@ UniValue getaddressbalance(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-
-    for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-        }
-    }
-
     CAmount balance = 0;
     CAmount received = 0;
+    int64_t txCount = 0;
+    int lastHeight = 0;
 
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
-        if (it->second > 0) {
-            received += it->second;
+    for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+        CAddressSummaryValue summary;
+        if (!GetAddressSummary((*it).first, (*it).second, summary)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
         }
-        balance += it->second;
+        balance += summary.balance;
+        received += summary.received;
+        txCount += summary.txCount;
+        lastHeight = std::max(lastHeight, summary.lastHeight);
     }
 
     UniValue result(UniValue::VOBJ);
     result.push_back(Pair("balance", balance));
     result.push_back(Pair("received", received));
+    result.push_back(Pair("txcount", txCount));
+    result.push_back(Pair("lastheight", lastHeight));
 
     return result;
 
@@ -1009,14 +1113,23 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
             "    ]\n"
             "  \"start\" (number) The start block height\n"
             "  \"end\" (number) The end block height\n"
+            "  \"limit\" (number, optional) Return at most this many txids per call, the addresses are returned\n"
+            "            one after the other instead of sorted by height\n"
+            "  \"cursor\" (string, optional) The cursor returned by the previous call, to continue after it\n"
             "}\n"
             "\nResult:\n"
             "[\n"
             "  \"transactionid\"  (string) The transaction id\n"
             "  ,...\n"
             "]\n"
+            "\nResult (with limit):\n"
+            "{\n"
+            "  \"txids\"  (array) The txids as above\n"
+            "  \"cursor\"  (string) Pass as cursor to get the next page, missing on the last page\n"
+            "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getaddresstxids", "'{\"addresses\": [\"idFcVh28YpxoCdJhiVjmsUn1Cq9rpJ6KP6\"]}'")
+            + HelpExampleCli("getaddresstxids", "'{\"addresses\": [\"idFcVh28YpxoCdJhiVjmsUn1Cq9rpJ6KP6\"], \"limit\": 1000}'")
             + HelpExampleRpc("getaddresstxids", "{\"addresses\": [\"idFcVh28YpxoCdJhiVjmsUn1Cq9rpJ6KP6\"]}")
         );
 
@@ -1039,6 +1152,28 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
 
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
+    size_t nLimit = 0;
+    std::string strCursor;
+    std::string strNextCursor;
+    if (getAddressPageFromParams(request.params, nLimit, strCursor)) {
+        getAddressIndexPage(addresses, start, end, nLimit, strCursor, addressIndex, strNextCursor);
+
+        // pages never end within a transaction, so adjacent entries are enough to return each txid once
+        UniValue txids(UniValue::VARR);
+        for (size_t i = 0; i < addressIndex.size(); i++) {
+            if (i == 0 || addressIndex[i].first.txhash != addressIndex[i - 1].first.txhash) {
+                txids.push_back(addressIndex[i].first.txhash.GetHex());
+            }
+        }
+
+        UniValue page(UniValue::VOBJ);
+        page.push_back(Pair("txids", txids));
+        if (!strNextCursor.empty()) {
+            page.push_back(Pair("cursor", strNextCursor));
+        }
+        return page;
+    }
+
     for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
         if (start > 0 && end > 0) {
             if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
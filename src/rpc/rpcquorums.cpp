@@ -12,6 +12,7 @@
 #include "llmq/quorums_debug.h"
 #include "llmq/quorums_dkgsession.h"
 #include "llmq/quorums_signing.h"
+#include "llmq/quorums_utils.h"
 
 void quorum_list_help()
 {
@@ -190,6 +191,14 @@ UniValue quorum_dkgstatus(const JSONRPCRequest& request)
 
     ret.push_back(Pair("minableCommitments", minableCommitments));
 
+    auto cacheStats = llmq::CLLMQUtils::GetQuorumMembersCacheStats();
+    UniValue membersCache(UniValue::VOBJ);
+    membersCache.push_back(Pair("membersHits", cacheStats.nMembersHits));
+    membersCache.push_back(Pair("membersMisses", cacheStats.nMembersMisses));
+    membersCache.push_back(Pair("connectionsHits", cacheStats.nConnectionsHits));
+    membersCache.push_back(Pair("connectionsMisses", cacheStats.nConnectionsMisses));
+    ret.push_back(Pair("quorumMembersCache", membersCache));
+
     return ret;
 }
 
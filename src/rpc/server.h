@@ -18,6 +18,7 @@
 
 #include <univalue.h>
 
+class CJSONWriter;
 class CRPCCommand;
 
 namespace RPCServer
@@ -45,8 +46,13 @@ public:
     bool fHelp;
     std::string URI;
     std::string authUser;
+    /**
+     * Set by transports that can send a result while it is produced. Commands with large results
+     * may write the result to it instead of returning it, and then return NullUniValue.
+     */
+    CJSONWriter* resultWriter;
 
-    JSONRPCRequest() : id(NullUniValue), params(NullUniValue), fHelp(false) {}
+    JSONRPCRequest() : id(NullUniValue), params(NullUniValue), fHelp(false), resultWriter(nullptr) {}
     void parse(const UniValue& valRequest);
 };
 
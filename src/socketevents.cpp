@@ -0,0 +1,320 @@
+// Copyright (c) 2020 The Ion Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "socketevents.h"
+
+#include "netbase.h"
+#include "util.h"
+#include "utiltime.h"
+
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode)
+{
+    if (str == "select") {
+#ifdef USE_POLL
+        // Sockets above FD_SETSIZE are accepted when poll is available, select can not wait for them
+        return false;
+#endif
+        mode = SOCKETEVENTS_SELECT;
+        return true;
+    }
+#ifdef USE_POLL
+    if (str == "poll") {
+        mode = SOCKETEVENTS_POLL;
+        return true;
+    }
+#endif
+#ifdef USE_EPOLL
+    if (str == "epoll") {
+        mode = SOCKETEVENTS_EPOLL;
+        return true;
+    }
+#endif
+    return false;
+}
+
+std::string SocketEventsModeToString(SocketEventsMode mode)
+{
+    switch (mode) {
+    case SOCKETEVENTS_SELECT: return "select";
+    case SOCKETEVENTS_POLL: return "poll";
+    case SOCKETEVENTS_EPOLL: return "epoll";
+    }
+    return "unknown";
+}
+
+std::string GetSupportedSocketEventsModes()
+{
+#if defined(USE_EPOLL)
+    return "epoll, poll";
+#elif defined(USE_POLL)
+    return "poll";
+#else
+    return "select";
+#endif
+}
+
+bool CSocketEvents::Set(SOCKET s, int64_t nOwner, uint8_t events)
+{
+    auto it = mapRegistered.find(s);
+    if (it == mapRegistered.end()) {
+        if (!Add(s, events))
+            return false;
+        mapRegistered.emplace(s, Registration{nOwner, events, true});
+        fChanged = true;
+        return true;
+    }
+
+    Registration& registration = it->second;
+    registration.fSet = true;
+    if (registration.nOwner != nOwner) {
+        // The socket number was closed and reused since it was registered
+        Delete(s);
+        fChanged = true;
+        if (!Add(s, events)) {
+            mapRegistered.erase(it);
+            return false;
+        }
+        registration.nOwner = nOwner;
+        registration.events = events;
+    } else if (registration.events != events) {
+        if (!Modify(s, events))
+            return false;
+        registration.events = events;
+        fChanged = true;
+    }
+    return true;
+}
+
+void CSocketEvents::Sweep()
+{
+    for (auto it = mapRegistered.begin(); it != mapRegistered.end(); ) {
+        if (!it->second.fSet) {
+            Delete(it->first);
+            it = mapRegistered.erase(it);
+            fChanged = true;
+        } else {
+            it->second.fSet = false;
+            ++it;
+        }
+    }
+}
+
+#ifndef USE_POLL
+/** Fallback for systems without poll, limited to sockets below FD_SETSIZE */
+class CSocketEventsSelect : public CSocketEvents
+{
+protected:
+    bool Add(SOCKET s, uint8_t events) override { return IsSelectableSocket(s); }
+    bool Modify(SOCKET s, uint8_t events) override { return true; }
+    void Delete(SOCKET s) override {}
+
+public:
+    SocketEventsMode GetMode() const override { return SOCKETEVENTS_SELECT; }
+
+    bool Wait(int64_t nTimeoutMs, std::unordered_map<SOCKET, uint8_t>& mapReady) override
+    {
+        mapReady.clear();
+        fChanged = false;
+
+        fd_set fdsetRecv;
+        fd_set fdsetSend;
+        fd_set fdsetError;
+        FD_ZERO(&fdsetRecv);
+        FD_ZERO(&fdsetSend);
+        FD_ZERO(&fdsetError);
+        SOCKET hSocketMax = 0;
+
+        for (const auto& it : GetRegistered()) {
+            FD_SET(it.first, &fdsetError);
+            if (it.second.events & SOCKET_EVENT_RECV)
+                FD_SET(it.first, &fdsetRecv);
+            if (it.second.events & SOCKET_EVENT_SEND)
+                FD_SET(it.first, &fdsetSend);
+            hSocketMax = std::max(hSocketMax, it.first);
+        }
+
+        struct timeval timeout = MillisToTimeval(nTimeoutMs);
+        if (GetRegistered().empty()) {
+            // select() fails without sockets on Windows
+            MilliSleep(nTimeoutMs);
+            return true;
+        }
+        if (select(hSocketMax + 1, &fdsetRecv, &fdsetSend, &fdsetError, &timeout) == SOCKET_ERROR)
+            return false;
+
+        for (const auto& it : GetRegistered()) {
+            uint8_t events = 0;
+            if (FD_ISSET(it.first, &fdsetRecv))
+                events |= SOCKET_EVENT_RECV;
+            if (FD_ISSET(it.first, &fdsetSend))
+                events |= SOCKET_EVENT_SEND;
+            if (FD_ISSET(it.first, &fdsetError))
+                events |= SOCKET_EVENT_ERR;
+            if (events)
+                mapReady.emplace(it.first, events);
+        }
+        return true;
+    }
+};
+#endif
+
+#ifdef USE_POLL
+class CSocketEventsPoll : public CSocketEvents
+{
+private:
+    // Rebuilt only when the registered sockets changed
+    std::vector<struct pollfd> vPollFds;
+
+protected:
+    bool Add(SOCKET s, uint8_t events) override { return true; }
+    bool Modify(SOCKET s, uint8_t events) override { return true; }
+    void Delete(SOCKET s) override {}
+
+public:
+    SocketEventsMode GetMode() const override { return SOCKETEVENTS_POLL; }
+
+    bool Wait(int64_t nTimeoutMs, std::unordered_map<SOCKET, uint8_t>& mapReady) override
+    {
+        mapReady.clear();
+        if (fChanged) {
+            vPollFds.clear();
+            vPollFds.reserve(GetRegistered().size());
+            for (const auto& it : GetRegistered()) {
+                struct pollfd pollfd = {};
+                pollfd.fd = it.first;
+                if (it.second.events & SOCKET_EVENT_RECV)
+                    pollfd.events |= POLLIN;
+                if (it.second.events & SOCKET_EVENT_SEND)
+                    pollfd.events |= POLLOUT;
+                vPollFds.push_back(pollfd);
+            }
+            fChanged = false;
+        }
+
+        if (poll(vPollFds.data(), vPollFds.size(), nTimeoutMs) == SOCKET_ERROR)
+            return false;
+
+        for (const struct pollfd& pollfd : vPollFds) {
+            uint8_t events = 0;
+            if (pollfd.revents & POLLIN)
+                events |= SOCKET_EVENT_RECV;
+            if (pollfd.revents & POLLOUT)
+                events |= SOCKET_EVENT_SEND;
+            if (pollfd.revents & (POLLERR | POLLHUP | POLLNVAL))
+                events |= SOCKET_EVENT_ERR;
+            if (events)
+                mapReady.emplace(pollfd.fd, events);
+        }
+        return true;
+    }
+};
+#endif
+
+#ifdef USE_EPOLL
+/** The kernel keeps the registered sockets, a wait only costs the number of ready sockets */
+class CSocketEventsEpoll : public CSocketEvents
+{
+private:
+    int epollfd;
+    std::vector<struct epoll_event> vEvents;
+
+    static uint32_t ToEpollEvents(uint8_t events)
+    {
+        uint32_t epollEvents = 0;
+        if (events & SOCKET_EVENT_RECV)
+            epollEvents |= EPOLLIN;
+        if (events & SOCKET_EVENT_SEND)
+            epollEvents |= EPOLLOUT;
+        return epollEvents;
+    }
+
+    bool Control(int op, SOCKET s, uint8_t events)
+    {
+        struct epoll_event event = {};
+        event.events = ToEpollEvents(events);
+        event.data.fd = s;
+        if (epoll_ctl(epollfd, op, s, &event) != 0) {
+            LogPrint(BCLog::NET, "%s: epoll_ctl for socket %d failed: %s\n", __func__, s, NetworkErrorString(errno));
+            return false;
+        }
+        return true;
+    }
+
+protected:
+    bool Add(SOCKET s, uint8_t events) override { return Control(EPOLL_CTL_ADD, s, events); }
+    bool Modify(SOCKET s, uint8_t events) override { return Control(EPOLL_CTL_MOD, s, events); }
+    void Delete(SOCKET s) override
+    {
+        // Closed sockets were already removed by the kernel
+        struct epoll_event event = {};
+        epoll_ctl(epollfd, EPOLL_CTL_DEL, s, &event);
+    }
+
+public:
+    CSocketEventsEpoll() : epollfd(epoll_create1(EPOLL_CLOEXEC)) {}
+    ~CSocketEventsEpoll() override
+    {
+        if (epollfd != -1)
+            close(epollfd);
+    }
+
+    bool IsValid() const { return epollfd != -1; }
+
+    SocketEventsMode GetMode() const override { return SOCKETEVENTS_EPOLL; }
+
+    bool Wait(int64_t nTimeoutMs, std::unordered_map<SOCKET, uint8_t>& mapReady) override
+    {
+        mapReady.clear();
+        fChanged = false;
+        vEvents.resize(std::max<size_t>(GetRegistered().size(), 1));
+
+        int nReady = epoll_wait(epollfd, vEvents.data(), vEvents.size(), nTimeoutMs);
+        if (nReady == SOCKET_ERROR)
+            return false;
+
+        for (int i = 0; i < nReady; i++) {
+            uint8_t events = 0;
+            if (vEvents[i].events & EPOLLIN)
+                events |= SOCKET_EVENT_RECV;
+            if (vEvents[i].events & EPOLLOUT)
+                events |= SOCKET_EVENT_SEND;
+            if (vEvents[i].events & (EPOLLERR | EPOLLHUP))
+                events |= SOCKET_EVENT_ERR;
+            SOCKET s = vEvents[i].data.fd;
+            mapReady.emplace(s, events);
+        }
+        return true;
+    }
+};
+#endif
+
+std::unique_ptr<CSocketEvents> CSocketEvents::Create(SocketEventsMode mode)
+{
+    switch (mode) {
+#ifndef USE_POLL
+    case SOCKETEVENTS_SELECT:
+        return std::unique_ptr<CSocketEvents>(new CSocketEventsSelect());
+#endif
+#ifdef USE_POLL
+    case SOCKETEVENTS_POLL:
+        return std::unique_ptr<CSocketEvents>(new CSocketEventsPoll());
+#endif
+#ifdef USE_EPOLL
+    case SOCKETEVENTS_EPOLL: {
+        std::unique_ptr<CSocketEventsEpoll> socketEvents(new CSocketEventsEpoll());
+        if (!socketEvents->IsValid()) {
+            LogPrintf("%s: epoll_create1 failed: %s\n", __func__, NetworkErrorString(errno));
+            return nullptr;
+        }
+        return std::move(socketEvents);
+    }
+#endif
+    default:
+        return nullptr;
+    }
+}
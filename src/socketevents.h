@@ -0,0 +1,88 @@
+// Copyright (c) 2020 The Ion Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef ION_SOCKETEVENTS_H
+#define ION_SOCKETEVENTS_H
+
+#include "compat.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum SocketEventsMode {
+    SOCKETEVENTS_SELECT,
+    SOCKETEVENTS_POLL,
+    SOCKETEVENTS_EPOLL,
+};
+
+#if defined(USE_EPOLL)
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SOCKETEVENTS_EPOLL;
+#elif defined(USE_POLL)
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SOCKETEVENTS_POLL;
+#else
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SOCKETEVENTS_SELECT;
+#endif
+
+/** Parse a -socketevents value, returns false if the mode is unknown or not available on this system */
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode);
+std::string SocketEventsModeToString(SocketEventsMode mode);
+/** Modes available on this system, for the help message */
+std::string GetSupportedSocketEventsModes();
+
+static const uint8_t SOCKET_EVENT_RECV = 1 << 0;
+static const uint8_t SOCKET_EVENT_SEND = 1 << 1;
+static const uint8_t SOCKET_EVENT_ERR = 1 << 2;
+
+/**
+ * Waits until sockets are ready to receive or send. The sockets and the events each one is waited
+ * for are registered once and kept across waits, only changes are passed on to the system.
+ * Errors are always reported, also for sockets that are waited for without events.
+ *
+ * A socket is registered together with the id of its owner, so that a socket number that was
+ * closed and reused by a new owner is registered again. Sockets that were not set since the
+ * previous call to Sweep are removed by it.
+ */
+class CSocketEvents
+{
+protected:
+    struct Registration {
+        int64_t nOwner;
+        uint8_t events;
+        bool fSet;
+    };
+
+private:
+    std::unordered_map<SOCKET, Registration> mapRegistered;
+
+protected:
+    // Registered sockets changed since the last wait
+    bool fChanged;
+
+    const std::unordered_map<SOCKET, Registration>& GetRegistered() const { return mapRegistered; }
+
+    virtual bool Add(SOCKET s, uint8_t events) = 0;
+    virtual bool Modify(SOCKET s, uint8_t events) = 0;
+    virtual void Delete(SOCKET s) = 0;
+
+public:
+    CSocketEvents() : fChanged(false) {}
+    virtual ~CSocketEvents() {}
+
+    static std::unique_ptr<CSocketEvents> Create(SocketEventsMode mode);
+
+    virtual SocketEventsMode GetMode() const = 0;
+
+    /** Wait for s to become ready for events (SOCKET_EVENT_RECV and/or SOCKET_EVENT_SEND) */
+    bool Set(SOCKET s, int64_t nOwner, uint8_t events);
+    /** Remove all sockets that were not set since the previous sweep */
+    void Sweep();
+    size_t Size() const { return mapRegistered.size(); }
+
+    /** Wait for at most nTimeoutMs milliseconds, and return the ready sockets with the events they are ready for */
+    virtual bool Wait(int64_t nTimeoutMs, std::unordered_map<SOCKET, uint8_t>& mapReady) = 0;
+};
+
+#endif // ION_SOCKETEVENTS_H
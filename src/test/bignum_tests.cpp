@@ -0,0 +1,109 @@
+// Copyright (c) 2018-2020 The Ion Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "libzerocoin/bignum.h"
+#include "test/test_ion.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(bignum_tests, BasicTestingSetup)
+
+static void CheckPowMod(const CBigNumFixedBase& fixed, const CBigNum& base, const CBigNum& modulus, const CBigNum& e)
+{
+    BOOST_CHECK(fixed.pow_mod(e) == base.pow_mod(e, modulus));
+}
+
+BOOST_AUTO_TEST_CASE(fixed_base_pow_mod_small)
+{
+    // 2039 = 2 * 1019 + 1, and 4 is a quadratic residue, so it generates the subgroup of order 1019
+    const CBigNum modulus(2039);
+    const CBigNum order(1019);
+    const CBigNum base(4);
+    const CBigNumFixedBase fixed(base, order, modulus);
+
+    for (int e = -2100; e <= 2100; e++) {
+        CheckPowMod(fixed, base, modulus, CBigNum(e));
+    }
+    BOOST_CHECK(fixed.pow_mod(CBigNum(0)).isOne());
+    BOOST_CHECK(fixed.pow_mod(CBigNum(1)) == base);
+    BOOST_CHECK(fixed.pow_mod(order).isOne());
+}
+
+BOOST_AUTO_TEST_CASE(fixed_base_pow_mod_large)
+{
+    // Any base to the power of p - 1 is one modulo a prime p
+    const CBigNum modulus = CBigNum::generatePrime(1024);
+    const CBigNum order = modulus - CBigNum(1);
+    const CBigNum base = CBigNum::randBignum(modulus);
+    const CBigNumFixedBase fixed(base, order, modulus);
+
+    CheckPowMod(fixed, base, modulus, CBigNum(0));
+    CheckPowMod(fixed, base, modulus, CBigNum(1));
+    CheckPowMod(fixed, base, modulus, order - CBigNum(1));
+    CheckPowMod(fixed, base, modulus, order);
+    CheckPowMod(fixed, base, modulus, order + CBigNum(1));
+    CheckPowMod(fixed, base, modulus, CBigNum(0) - CBigNum(1));
+    for (int i = 0; i < 50; i++) {
+        // Exponents wider than the order exercise the reduction
+        const CBigNum e = CBigNum::randKBitBignum(2048);
+        CheckPowMod(fixed, base, modulus, e);
+        CheckPowMod(fixed, base, modulus, CBigNum(0) - e);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(fixed_base_mul_pow_mod)
+{
+    const CBigNum modulus = CBigNum::generatePrime(1024);
+    const CBigNum order = modulus - CBigNum(1);
+    const CBigNum g = CBigNum::randBignum(modulus);
+    const CBigNum h = CBigNum::randBignum(modulus);
+    const CBigNumFixedBase fixedG(g, order, modulus);
+    const CBigNumFixedBase fixedH(h, order, modulus);
+
+    for (int i = 0; i < 50; i++) {
+        const CBigNum e1 = CBigNum::randKBitBignum(1024);
+        const CBigNum e2 = CBigNum::randKBitBignum(1024);
+        const CBigNum expected = g.pow_mod(e1, modulus).mul_mod(h.pow_mod(e2, modulus), modulus);
+        BOOST_CHECK(fixedG.mul_pow_mod(e1, fixedH, e2) == expected);
+    }
+    BOOST_CHECK(fixedG.mul_pow_mod(CBigNum(0), fixedH, CBigNum(0)).isOne());
+    BOOST_CHECK(fixedG.mul_pow_mod(CBigNum(1), fixedH, CBigNum(0)) == g);
+    BOOST_CHECK(fixedG.mul_pow_mod(CBigNum(0), fixedH, CBigNum(1)) == h);
+
+    // A second base without a table falls back to pow_mod
+    const CBigNumFixedBase fixedNoTable(h, CBigNum(0), modulus);
+    const CBigNum e1 = CBigNum::randKBitBignum(1024);
+    const CBigNum e2 = CBigNum::randKBitBignum(1024);
+    const CBigNum expected = g.pow_mod(e1, modulus).mul_mod(h.pow_mod(e2, modulus), modulus);
+    BOOST_CHECK(fixedG.mul_pow_mod(e1, fixedNoTable, e2) == expected);
+}
+
+BOOST_AUTO_TEST_CASE(fixed_base_pow_mod_fallback)
+{
+    const CBigNum base(4);
+
+    // Modulus one
+    const CBigNumFixedBase fixedModOne(base, CBigNum(1019), CBigNum(1));
+    for (int e = -3; e <= 3; e++) {
+        CheckPowMod(fixedModOne, base, CBigNum(1), CBigNum(e));
+        BOOST_CHECK(fixedModOne.pow_mod(CBigNum(e)) == CBigNum(0));
+    }
+
+    // An order that is not the order of base must not be used to reduce exponents
+    const CBigNum modulus(2039);
+    const CBigNumFixedBase fixedWrongOrder(base, CBigNum(1000), modulus);
+    for (int e = 0; e <= 2100; e++) {
+        CheckPowMod(fixedWrongOrder, base, modulus, CBigNum(e));
+    }
+
+    // Orders of zero and one
+    const CBigNumFixedBase fixedOrderZero(base, CBigNum(0), modulus);
+    const CBigNumFixedBase fixedOrderOne(base, CBigNum(1), modulus);
+    for (int e = 0; e <= 100; e++) {
+        CheckPowMod(fixedOrderZero, base, modulus, CBigNum(e));
+        CheckPowMod(fixedOrderOne, base, modulus, CBigNum(e));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,7 @@
 
 #include "bls/bls.h"
 #include "bls/bls_batchverifier.h"
+#include "bls/bls_worker.h"
 #include "test/test_ion.h"
 
 #include <boost/test/unit_test.hpp>
@@ -77,9 +78,9 @@ static void AddMessage(std::vector<Message>& vec, uint32_t sourceId, uint32_t ms
     vec.emplace_back(m);
 }
 
-static void Verify(std::vector<Message>& vec, bool secureVerification, bool perMessageFallback)
+static void Verify(std::vector<Message>& vec, bool secureVerification, bool perMessageFallback, CBLSWorker* worker = nullptr)
 {
-    CBLSBatchVerifier<uint32_t, uint32_t> batchVerifier(secureVerification, perMessageFallback);
+    CBLSBatchVerifier<uint32_t, uint32_t> batchVerifier(secureVerification, perMessageFallback, 0, worker);
 
     std::set<uint32_t> expectedBadMessages;
     std::set<uint32_t> expectedBadSources;
@@ -109,6 +110,14 @@ static void Verify(std::vector<Message>& vec)
     Verify(vec, true, false);
     Verify(vec, false, true);
     Verify(vec, true, true);
+
+    CBLSWorker worker;
+    worker.Start();
+    Verify(vec, false, false, &worker);
+    Verify(vec, true, false, &worker);
+    Verify(vec, false, true, &worker);
+    Verify(vec, true, true, &worker);
+    worker.Stop();
 }
 
 BOOST_AUTO_TEST_CASE(batch_verifier_tests)
@@ -154,4 +163,20 @@ BOOST_AUTO_TEST_CASE(batch_verifier_tests)
     Verify(msgs);
 }
 
+BOOST_AUTO_TEST_CASE(batch_verifier_bisection_tests)
+{
+    // enough messages to be split up into sub-batches, with a few invalid ones spread over them
+    std::vector<Message> msgs;
+    for (uint32_t i = 0; i < 100; i++) {
+        AddMessage(msgs, i % 10, i, i, i % 37 != 5);
+    }
+    Verify(msgs);
+
+    // one source sending only invalid messages
+    for (uint32_t i = 100; i < 120; i++) {
+        AddMessage(msgs, 10, i, i, false);
+    }
+    Verify(msgs);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
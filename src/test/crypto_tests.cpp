@@ -13,6 +13,7 @@
 #include "crypto/sha512.h"
 #include "crypto/hmac_sha256.h"
 #include "crypto/hmac_sha512.h"
+#include "crypto/x11.h"
 #include "random.h"
 #include "utilstrencodings.h"
 #include "test/test_ion.h"
@@ -784,4 +785,23 @@ BOOST_AUTO_TEST_CASE(sha256d64)
     }
 }
 
+BOOST_AUTO_TEST_CASE(x11_nonce_hasher)
+{
+    unsigned char header[80];
+    for (int j = 0; j < 80; ++j) {
+        header[j] = InsecureRandBits(8);
+    }
+    uint32_t nNonce = InsecureRand32();
+    CX11NonceHasher hasher(header, sizeof(header));
+    for (size_t count = 0; count <= CX11NonceHasher::BATCH_SIZE; ++count) {
+        unsigned char out[32 * CX11NonceHasher::BATCH_SIZE];
+        hasher.Hash(nNonce, count, out);
+        for (size_t j = 0; j < count; ++j) {
+            WriteLE32(header + CX11NonceHasher::NONCE_OFFSET, nNonce + j);
+            uint256 hash = HashX11(header, header + sizeof(header));
+            BOOST_CHECK(memcmp(hash.begin(), out + 32 * j, 32) == 0);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "dbwrapper.h"
+#include "txdb.h"
 #include "uint256.h"
 #include "random.h"
 #include "test/test_ion.h"
@@ -115,9 +116,102 @@ BOOST_AUTO_TEST_CASE(dbwrapper_iterator)
 
         it->Next();
         BOOST_CHECK_EQUAL(it->Valid(), false);
+
+        it->SeekToLast();
+        it->GetKey(key_res);
+        BOOST_CHECK_EQUAL(key_res, key2);
+
+        it->Prev();
+        it->GetKey(key_res);
+        it->GetValue(val_res);
+        BOOST_CHECK_EQUAL(key_res, key);
+        BOOST_CHECK_EQUAL(val_res.ToString(), in.ToString());
     }
 }
 
+BOOST_AUTO_TEST_CASE(address_summary_index)
+{
+    CBlockTreeDB blocktree(1 << 20, true);
+    uint160 hashBytes = uint160(std::vector<unsigned char>(20, 1));
+    uint160 hashBytes2 = uint160(std::vector<unsigned char>(20, 2));
+    uint256 txid1 = InsecureRand256();
+    uint256 txid2 = InsecureRand256();
+    uint256 txid3 = InsecureRand256();
+
+    // receive in block 10, spend with change in block 20
+    std::vector<std::pair<CAddressIndexKey, CAmount> > block10 = {
+        {CAddressIndexKey(1, hashBytes, 10, 1, txid1, 0, false), 500},
+        {CAddressIndexKey(1, hashBytes2, 10, 1, txid1, 1, false), 50},
+    };
+    std::vector<std::pair<CAddressIndexKey, CAmount> > block20 = {
+        {CAddressIndexKey(1, hashBytes, 20, 1, txid2, 0, true), -500},
+        {CAddressIndexKey(1, hashBytes, 20, 1, txid2, 1, false), 200},
+        {CAddressIndexKey(1, hashBytes, 20, 2, txid3, 0, false), 100},
+    };
+    BOOST_CHECK(blocktree.WriteAddressIndex(block10));
+    BOOST_CHECK(blocktree.WriteAddressIndex(block20));
+
+    CAddressSummaryValue summary;
+    BOOST_CHECK(blocktree.ReadAddressSummary(hashBytes, 1, summary));
+    BOOST_CHECK_EQUAL(summary.balance, 300);
+    BOOST_CHECK_EQUAL(summary.received, 800);
+    BOOST_CHECK_EQUAL(summary.txCount, 3);
+    BOOST_CHECK_EQUAL(summary.lastHeight, 20);
+
+    // connecting an already indexed block again, as -reindex-chainstate does, leaves the summary alone
+    BOOST_CHECK(blocktree.WriteAddressIndex(block20));
+    CAddressSummaryValue rewritten;
+    BOOST_CHECK(blocktree.ReadAddressSummary(hashBytes, 1, rewritten));
+    BOOST_CHECK_EQUAL(rewritten.balance, summary.balance);
+    BOOST_CHECK_EQUAL(rewritten.received, summary.received);
+    BOOST_CHECK_EQUAL(rewritten.txCount, summary.txCount);
+
+    // pages end at transaction boundaries
+    size_t nLimit = 2;
+    std::vector<std::pair<CAddressIndexKey, CAmount> > page;
+    CAddressIndexKey nextKey;
+    bool fMore;
+    BOOST_CHECK(blocktree.ReadAddressIndexPage(CAddressIndexKey(1, hashBytes, 0, 0, uint256(), 0, false), 0, nLimit, page, nextKey, fMore));
+    BOOST_CHECK_EQUAL(page.size(), 3);
+    BOOST_CHECK(fMore);
+    BOOST_CHECK(nextKey.txhash == txid3);
+    nLimit = 2;
+    BOOST_CHECK(blocktree.ReadAddressIndexPage(nextKey, 0, nLimit, page, nextKey, fMore));
+    BOOST_CHECK_EQUAL(page.size(), 4);
+    BOOST_CHECK(!fMore);
+    BOOST_CHECK_EQUAL(nLimit, 1);
+
+    // a summary built from the index matches the incrementally maintained one
+    BOOST_CHECK(blocktree.BuildAddressSummaryIndex());
+    CAddressSummaryValue built;
+    BOOST_CHECK(blocktree.ReadAddressSummary(hashBytes, 1, built));
+    BOOST_CHECK_EQUAL(built.balance, summary.balance);
+    BOOST_CHECK_EQUAL(built.received, summary.received);
+    BOOST_CHECK_EQUAL(built.txCount, summary.txCount);
+    BOOST_CHECK_EQUAL(built.lastHeight, summary.lastHeight);
+
+    // disconnecting block 20 restores the previous last height
+    BOOST_CHECK(blocktree.EraseAddressIndex(block20));
+    BOOST_CHECK(blocktree.ReadAddressSummary(hashBytes, 1, summary));
+    BOOST_CHECK_EQUAL(summary.balance, 500);
+    BOOST_CHECK_EQUAL(summary.received, 500);
+    BOOST_CHECK_EQUAL(summary.txCount, 1);
+    BOOST_CHECK_EQUAL(summary.lastHeight, 10);
+
+    // undoing it twice doesn't subtract twice
+    BOOST_CHECK(blocktree.EraseAddressIndex(block20));
+    BOOST_CHECK(blocktree.ReadAddressSummary(hashBytes, 1, summary));
+    BOOST_CHECK_EQUAL(summary.balance, 500);
+    BOOST_CHECK_EQUAL(summary.txCount, 1);
+
+    // and disconnecting block 10 removes the summaries
+    BOOST_CHECK(blocktree.EraseAddressIndex(block10));
+    BOOST_CHECK(blocktree.ReadAddressSummary(hashBytes, 1, summary));
+    BOOST_CHECK(summary.IsNull());
+    BOOST_CHECK(blocktree.ReadAddressSummary(hashBytes2, 1, summary));
+    BOOST_CHECK(summary.IsNull());
+}
+
 // Test that we do not obfuscation if there is existing data.
 BOOST_AUTO_TEST_CASE(existing_data_no_obfuscate)
 {
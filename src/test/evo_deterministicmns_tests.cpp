@@ -22,75 +22,6 @@
 
 #include <boost/test/unit_test.hpp>
 
-typedef std::map<COutPoint, std::pair<int, CAmount>> SimpleUTXOMap;
-
-static SimpleUTXOMap BuildSimpleUtxoMap(const std::vector<CTransaction>& txs)
-{
-    SimpleUTXOMap utxos;
-    for (size_t i = 0; i < txs.size(); i++) {
-        auto& tx = txs[i];
-        for (size_t j = 0; j < tx.vout.size(); j++) {
-            utxos.emplace(COutPoint(tx.GetHash(), j), std::make_pair((int)i + 1, tx.vout[j].nValue));
-        }
-    }
-    return utxos;
-}
-
-static std::vector<COutPoint> SelectUTXOs(SimpleUTXOMap& utoxs, CAmount amount, CAmount& changeRet)
-{
-    changeRet = 0;
-
-    std::vector<COutPoint> selectedUtxos;
-    CAmount selectedAmount = 0;
-    while (!utoxs.empty()) {
-        bool found = false;
-        for (auto it = utoxs.begin(); it != utoxs.end(); ++it) {
-            if (chainActive.Height() - it->second.first < 101) {
-                continue;
-            }
-
-            found = true;
-            selectedAmount += it->second.second;
-            selectedUtxos.emplace_back(it->first);
-            utoxs.erase(it);
-            break;
-        }
-        BOOST_ASSERT(found);
-        if (selectedAmount >= amount) {
-            changeRet = selectedAmount - amount;
-            break;
-        }
-    }
-
-    return selectedUtxos;
-}
-
-static void FundTransaction(CMutableTransaction& tx, SimpleUTXOMap& utoxs, const CScript& scriptPayout, CAmount amount, const CKey& coinbaseKey)
-{
-    CAmount change;
-    auto inputs = SelectUTXOs(utoxs, amount, change);
-    for (size_t i = 0; i < inputs.size(); i++) {
-        tx.vin.emplace_back(CTxIn(inputs[i]));
-    }
-    tx.vout.emplace_back(CTxOut(amount, scriptPayout));
-    if (change != 0) {
-        tx.vout.emplace_back(CTxOut(change, scriptPayout));
-    }
-}
-
-static void SignTransaction(CMutableTransaction& tx, const CKey& coinbaseKey)
-{
-    CBasicKeyStore tempKeystore;
-    tempKeystore.AddKeyPubKey(coinbaseKey, coinbaseKey.GetPubKey());
-
-    for (size_t i = 0; i < tx.vin.size(); i++) {
-        CTransactionRef txFrom;
-        uint256 hashBlock;
-        BOOST_ASSERT(GetTransaction(tx.vin[i].prevout.hash, txFrom, Params().GetConsensus(), hashBlock));
-        BOOST_ASSERT(SignSignature(tempKeystore, *txFrom, tx, i, SIGHASH_ALL));
-    }
-}
-
 static CMutableTransaction CreateProRegTx(SimpleUTXOMap& utxos, int port, const CScript& scriptPayout, const CKey& coinbaseKey, CKey& ownerKeyRet, CBLSSecretKey& operatorKeyRet)
 {
     ownerKeyRet.MakeNewKey(true);
@@ -110,7 +41,7 @@ static CMutableTransaction CreateProRegTx(SimpleUTXOMap& utxos, int port, const
     CMutableTransaction tx;
     tx.nVersion = 3;
     tx.nType = TRANSACTION_PROVIDER_REGISTER;
-    FundTransaction(tx, utxos, scriptPayout, MASTERNODE_COLLATERAL_AMOUNT, coinbaseKey);
+    FundTransaction(tx, utxos, scriptPayout, MASTERNODE_COLLATERAL_AMOUNT);
     proTx.inputsHash = CalcTxInputsHash(tx);
     SetTxPayload(tx, proTx);
     SignTransaction(tx, coinbaseKey);
@@ -131,7 +62,7 @@ static CMutableTransaction CreateProUpServTx(SimpleUTXOMap& utxos, const uint256
     CMutableTransaction tx;
     tx.nVersion = 3;
     tx.nType = TRANSACTION_PROVIDER_UPDATE_SERVICE;
-    FundTransaction(tx, utxos, GetScriptForDestination(coinbaseKey.GetPubKey().GetID()), 1 * COIN, coinbaseKey);
+    FundTransaction(tx, utxos, GetScriptForDestination(coinbaseKey.GetPubKey().GetID()), 1 * COIN);
     proTx.inputsHash = CalcTxInputsHash(tx);
     proTx.sig = operatorKey.Sign(::SerializeHash(proTx));
     SetTxPayload(tx, proTx);
@@ -154,7 +85,7 @@ static CMutableTransaction CreateProUpRegTx(SimpleUTXOMap& utxos, const uint256&
     CMutableTransaction tx;
     tx.nVersion = 3;
     tx.nType = TRANSACTION_PROVIDER_UPDATE_REGISTRAR;
-    FundTransaction(tx, utxos, GetScriptForDestination(coinbaseKey.GetPubKey().GetID()), 1 * COIN, coinbaseKey);
+    FundTransaction(tx, utxos, GetScriptForDestination(coinbaseKey.GetPubKey().GetID()), 1 * COIN);
     proTx.inputsHash = CalcTxInputsHash(tx);
     CHashSigner::SignHash(::SerializeHash(proTx), mnKey, proTx.vchSig);
     SetTxPayload(tx, proTx);
@@ -174,7 +105,7 @@ static CMutableTransaction CreateProUpRevTx(SimpleUTXOMap& utxos, const uint256&
     CMutableTransaction tx;
     tx.nVersion = 3;
     tx.nType = TRANSACTION_PROVIDER_UPDATE_REVOKE;
-    FundTransaction(tx, utxos, GetScriptForDestination(coinbaseKey.GetPubKey().GetID()), 1 * COIN, coinbaseKey);
+    FundTransaction(tx, utxos, GetScriptForDestination(coinbaseKey.GetPubKey().GetID()), 1 * COIN);
     proTx.inputsHash = CalcTxInputsHash(tx);
     proTx.sig = operatorKey.Sign(::SerializeHash(proTx));
     SetTxPayload(tx, proTx);
@@ -453,4 +384,145 @@ BOOST_FIXTURE_TEST_CASE(dip3_protx, TestChainDIP3Setup)
 
     const_cast<Consensus::Params&>(Params().GetConsensus()).DIP0003EnforcementHeight = DIP0003EnforcementHeightBackup;
 }
+
+BOOST_FIXTURE_TEST_CASE(dip3_payee_index, BasicTestingSetup)
+{
+    FastRandomContext rnd(true);
+    CDeterministicMNList mnList(uint256(), 0, 0);
+    std::vector<uint256> proTxHashes;
+    for (int i = 0; i < 200; i++) {
+        auto dmn = std::make_shared<CDeterministicMN>();
+        dmn->proTxHash = rnd.rand256();
+        dmn->internalId = i;
+        dmn->collateralOutpoint = COutPoint(rnd.rand256(), 0);
+        dmn->nOperatorReward = 0;
+        auto state = std::make_shared<CDeterministicMNState>();
+        state->nRegisteredHeight = rnd.randrange(100);
+        state->keyIDOwner = CKeyID(uint160(rnd.randbytes(20)));
+        dmn->pdmnState = state;
+        mnList.AddMN(dmn);
+        proTxHashes.emplace_back(dmn->proTxHash);
+    }
+
+    for (int nHeight = 100; nHeight < 600; nHeight++) {
+        // pay the expected payee, and randomly ban, revive or remove others
+        auto payee = mnList.GetMNPayee();
+        BOOST_REQUIRE(payee != nullptr);
+        auto newState = std::make_shared<CDeterministicMNState>(*payee->pdmnState);
+        newState->nLastPaidHeight = nHeight;
+        mnList.UpdateMN(payee->proTxHash, newState);
+
+        auto dmn = mnList.GetMN(proTxHashes[rnd.randrange(proTxHashes.size())]);
+        if (dmn && rnd.randbool()) {
+            auto state = std::make_shared<CDeterministicMNState>(*dmn->pdmnState);
+            if (state->nPoSeBanHeight == -1) {
+                state->nPoSeBanHeight = nHeight;
+            } else {
+                state->nPoSeBanHeight = -1;
+                state->nPoSeRevivedHeight = nHeight;
+            }
+            mnList.UpdateMN(dmn->proTxHash, state);
+        } else if (dmn && rnd.randrange(10) == 0) {
+            mnList.RemoveMN(dmn->proTxHash);
+        }
+
+        // the index must give the same order as sorting all valid MNs
+        std::vector<CDeterministicMNCPtr> expected;
+        mnList.ForEachMN(true, [&](const CDeterministicMNCPtr& dmn) {
+            expected.emplace_back(dmn);
+        });
+        std::sort(expected.begin(), expected.end(), [](const CDeterministicMNCPtr& a, const CDeterministicMNCPtr& b) {
+            auto heightA = a->pdmnState->nLastPaidHeight;
+            if (a->pdmnState->nPoSeRevivedHeight != -1 && a->pdmnState->nPoSeRevivedHeight > heightA) {
+                heightA = a->pdmnState->nPoSeRevivedHeight;
+            } else if (heightA == 0) {
+                heightA = a->pdmnState->nRegisteredHeight;
+            }
+            auto heightB = b->pdmnState->nLastPaidHeight;
+            if (b->pdmnState->nPoSeRevivedHeight != -1 && b->pdmnState->nPoSeRevivedHeight > heightB) {
+                heightB = b->pdmnState->nPoSeRevivedHeight;
+            } else if (heightB == 0) {
+                heightB = b->pdmnState->nRegisteredHeight;
+            }
+            return std::make_pair(heightA, a->proTxHash) < std::make_pair(heightB, b->proTxHash);
+        });
+        BOOST_CHECK_EQUAL(mnList.GetValidMNsCount(), expected.size());
+        auto projected = mnList.GetProjectedMNPayees(expected.size() + 1);
+        BOOST_REQUIRE_EQUAL(projected.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            BOOST_CHECK(projected[i]->proTxHash == expected[i]->proTxHash);
+        }
+    }
+}
+
+static bool HasListSnapshot(const CBlockIndex* pindex)
+{
+    return evoDb->GetRawDB().Exists(std::make_pair(std::string("dmn_S"), pindex->GetBlockHash()));
+}
+
+BOOST_FIXTURE_TEST_CASE(dip3_snapshot_interval_migration, TestChainDIP3Setup)
+{
+    const int nOldInterval = 10;
+    const int nNewInterval = 7;
+
+    // connect the DIP3 blocks with a snapshot every nOldInterval blocks
+    delete deterministicMNManager;
+    deterministicMNManager = new CDeterministicMNManager(*evoDb, nOldInterval);
+    deterministicMNManager->UpdatedBlockTip(chainActive.Tip());
+    deterministicMNManager->MigrateSnapshotIntervalIfNeeded();
+
+    auto utxos = BuildSimpleUtxoMap(coinbaseTxns);
+    int port = 1;
+
+    // register a few MNs, then mine until the first DIP3 lists are no longer pinned as recent lists
+    std::map<int, uint256> mapListHashes;
+    const int nStartHeight = chainActive.Height() + 1;
+    while (chainActive.Height() < nStartHeight + 600) {
+        std::vector<CMutableTransaction> txns;
+        if (chainActive.Height() + 1 < nStartHeight + 3) {
+            CKey ownerKey;
+            CBLSSecretKey operatorKey;
+            txns.emplace_back(CreateProRegTx(utxos, port++, GenerateRandomAddress(), coinbaseKey, ownerKey, operatorKey));
+        }
+        CreateAndProcessBlock(txns, coinbaseKey);
+        deterministicMNManager->UpdatedBlockTip(chainActive.Tip());
+        mapListHashes.emplace(chainActive.Height(), ::SerializeHash(deterministicMNManager->GetListForBlock(chainActive.Tip())));
+    }
+    BOOST_REQUIRE_EQUAL(deterministicMNManager->GetListForBlock(chainActive.Tip()).GetAllMNsCount(), 3);
+
+    // the migration works on the DB, like it does on startup
+    evoDb->CommitRootTransaction();
+    for (const auto& p : mapListHashes) {
+        // the first DIP3 block always gets a snapshot
+        BOOST_CHECK_EQUAL(HasListSnapshot(chainActive[p.first]), (p.first % nOldInterval) == 0 || p.first == nStartHeight);
+    }
+
+    // restart with a different interval and a historical list cache which only fits a few lists
+    delete deterministicMNManager;
+    deterministicMNManager = new CDeterministicMNManager(*evoDb, nNewInterval, 4 << 10);
+    deterministicMNManager->UpdatedBlockTip(chainActive.Tip());
+    deterministicMNManager->MigrateSnapshotIntervalIfNeeded();
+
+    int nInterval = 0;
+    BOOST_CHECK(evoDb->GetRawDB().Read(std::string("dmn_SI"), nInterval));
+    BOOST_CHECK_EQUAL(nInterval, nNewInterval);
+    for (const auto& p : mapListHashes) {
+        BOOST_CHECK_EQUAL(HasListSnapshot(chainActive[p.first]), (p.first % nNewInterval) == 0 || p.first == nStartHeight);
+    }
+
+    // all lists are rebuilt from the new snapshots, the ones older than the pinned lists go through the LRU
+    for (const auto& p : mapListHashes) {
+        BOOST_CHECK(::SerializeHash(deterministicMNManager->GetListForBlock(chainActive[p.first])) == p.second);
+    }
+    // request old lists again in an order which makes the LRU evict and reload some of them
+    for (int nHeight : {nStartHeight + 1, nStartHeight + 20, nStartHeight + 1, nStartHeight + 8, nStartHeight + 15, nStartHeight + 20, nStartHeight + 1}) {
+        BOOST_CHECK(::SerializeHash(deterministicMNManager->GetListForBlock(chainActive[nHeight])) == mapListHashes[nHeight]);
+    }
+
+    // a second start with the same interval leaves the snapshots alone
+    deterministicMNManager->MigrateSnapshotIntervalIfNeeded();
+    for (const auto& p : mapListHashes) {
+        BOOST_CHECK_EQUAL(HasListSnapshot(chainActive[p.first]), (p.first % nNewInterval) == 0 || p.first == nStartHeight);
+    }
+}
 BOOST_AUTO_TEST_SUITE_END()
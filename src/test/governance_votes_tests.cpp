@@ -0,0 +1,220 @@
+// Copyright (c) 2018-2020 The Ion Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "test/test_ion.h"
+
+#include "governance/governance.h"
+#include "governance/governance-object.h"
+#include "governance/governance-vote.h"
+#include "keystore.h"
+#include "netbase.h"
+#include "script/sign.h"
+#include "script/standard.h"
+#include "utilstrencodings.h"
+#include "validation.h"
+
+#include "evo/specialtx.h"
+#include "evo/providertx.h"
+#include "evo/deterministicmns.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(governance_votes_tests, TestChainDIP3Setup)
+
+class TestGovernanceManager
+{
+public:
+    static void AddObject(const CGovernanceObject& govobj)
+    {
+        LOCK(governance.cs);
+        governance.mapObjects.emplace(govobj.GetHash(), govobj);
+    }
+
+    static void QueueVote(NodeId nodeId, const CGovernanceVote& vote)
+    {
+        LOCK(governance.cs);
+        governance.mapPendingVotes[nodeId].emplace_back(vote);
+    }
+
+    static bool IsInvalidVote(const CGovernanceVote& vote)
+    {
+        LOCK(governance.cs);
+        return governance.cmapInvalidVotes.HasKey(vote.GetHash());
+    }
+};
+
+struct TestMasternode
+{
+    COutPoint collateralOutpoint;
+    CKey votingKey;
+    CBLSSecretKey operatorKey;
+};
+
+// Registers the masternodes in a single block, the owner key is used as the voting key
+static std::vector<TestMasternode> RegisterMasternodes(TestChainSetup& setup, size_t nCount)
+{
+    auto utxos = BuildSimpleUtxoMap(setup.coinbaseTxns);
+    CScript scriptPayout = GetScriptForDestination(setup.coinbaseKey.GetPubKey().GetID());
+
+    std::vector<TestMasternode> vecMasternodes;
+    std::vector<CMutableTransaction> txns;
+    for (size_t i = 0; i < nCount; i++) {
+        TestMasternode mn;
+        mn.votingKey.MakeNewKey(true);
+        mn.operatorKey.MakeNewKey();
+
+        CProRegTx proTx;
+        proTx.collateralOutpoint.n = 0;
+        proTx.addr = LookupNumeric("1.1.1.1", i + 1);
+        proTx.keyIDOwner = mn.votingKey.GetPubKey().GetID();
+        proTx.pubKeyOperator = mn.operatorKey.GetPublicKey();
+        proTx.keyIDVoting = mn.votingKey.GetPubKey().GetID();
+        proTx.scriptPayout = scriptPayout;
+
+        CMutableTransaction tx;
+        tx.nVersion = 3;
+        tx.nType = TRANSACTION_PROVIDER_REGISTER;
+        FundTransaction(tx, utxos, scriptPayout, MASTERNODE_COLLATERAL_AMOUNT);
+        proTx.inputsHash = CalcTxInputsHash(tx);
+        SetTxPayload(tx, proTx);
+        SignTransaction(tx, setup.coinbaseKey);
+        txns.emplace_back(tx);
+
+        mn.collateralOutpoint = COutPoint(tx.GetHash(), 0);
+        vecMasternodes.emplace_back(mn);
+    }
+
+    setup.CreateAndProcessBlock(txns, setup.coinbaseKey);
+    deterministicMNManager->UpdatedBlockTip(chainActive.Tip());
+
+    auto mnList = deterministicMNManager->GetListAtChainTip();
+    for (const auto& mn : vecMasternodes) {
+        BOOST_REQUIRE(mnList.HasMNByCollateral(mn.collateralOutpoint));
+    }
+    return vecMasternodes;
+}
+
+static CGovernanceObject CreateProposal()
+{
+    std::string strData = "{\"name\":\"test\",\"type\":1,\"url\":\"http://test.com\"}";
+    CGovernanceObject govobj(uint256(), 1, GetAdjustedTime(), uint256(), HexStr(strData));
+    BOOST_REQUIRE(govobj.GetObjectType() == GOVERNANCE_OBJECT_PROPOSAL);
+    TestGovernanceManager::AddObject(govobj);
+    return govobj;
+}
+
+static CGovernanceVote CreateVotingKeyVote(const TestMasternode& mn, const uint256& nParentHash, const CKey& key)
+{
+    CGovernanceVote vote(mn.collateralOutpoint, nParentHash, VOTE_SIGNAL_FUNDING, VOTE_OUTCOME_YES);
+    BOOST_REQUIRE(vote.Sign(key, key.GetPubKey().GetID()));
+    return vote;
+}
+
+static CGovernanceVote CreateOperatorKeyVote(const TestMasternode& mn, const uint256& nParentHash, const CBLSSecretKey& key)
+{
+    CGovernanceVote vote(mn.collateralOutpoint, nParentHash, VOTE_SIGNAL_VALID, VOTE_OUTCOME_YES);
+    BOOST_REQUIRE(vote.Sign(key));
+    return vote;
+}
+
+BOOST_AUTO_TEST_CASE(pending_votes_mixed_signatures)
+{
+    auto vecMasternodes = RegisterMasternodes(*this, 4);
+    uint256 nParentHash = CreateProposal().GetHash();
+
+    CKey otherKey;
+    otherKey.MakeNewKey(true);
+    CBLSSecretKey otherOperatorKey;
+    otherOperatorKey.MakeNewKey();
+
+    std::vector<CGovernanceVote> vecGood = {
+        CreateVotingKeyVote(vecMasternodes[0], nParentHash, vecMasternodes[0].votingKey),
+        CreateVotingKeyVote(vecMasternodes[1], nParentHash, vecMasternodes[1].votingKey),
+        CreateOperatorKeyVote(vecMasternodes[0], nParentHash, vecMasternodes[0].operatorKey),
+        CreateOperatorKeyVote(vecMasternodes[2], nParentHash, vecMasternodes[2].operatorKey),
+    };
+    std::vector<CGovernanceVote> vecBad = {
+        // signed by a key that doesn't belong to the masternode
+        CreateVotingKeyVote(vecMasternodes[2], nParentHash, otherKey),
+        CreateOperatorKeyVote(vecMasternodes[1], nParentHash, otherOperatorKey),
+    };
+    {
+        // funding votes on proposals must be signed by the voting key
+        CGovernanceVote vote(vecMasternodes[3].collateralOutpoint, nParentHash, VOTE_SIGNAL_FUNDING, VOTE_OUTCOME_NO);
+        BOOST_REQUIRE(vote.Sign(vecMasternodes[3].operatorKey));
+        vecBad.emplace_back(vote);
+    }
+
+    // spread the votes over two peers, bad and good ones interleaved
+    for (size_t i = 0; i < std::max(vecGood.size(), vecBad.size()); i++) {
+        if (i < vecBad.size()) {
+            TestGovernanceManager::QueueVote(i % 2, vecBad[i]);
+        }
+        if (i < vecGood.size()) {
+            TestGovernanceManager::QueueVote(i % 2, vecGood[i]);
+        }
+    }
+    governance.ProcessPendingVotes(*connman);
+
+    for (const auto& vote : vecGood) {
+        BOOST_CHECK(governance.HaveVoteForHash(vote.GetHash()));
+        BOOST_CHECK(!TestGovernanceManager::IsInvalidVote(vote));
+    }
+    for (const auto& vote : vecBad) {
+        BOOST_CHECK(!governance.HaveVoteForHash(vote.GetHash()));
+        BOOST_CHECK(TestGovernanceManager::IsInvalidVote(vote));
+    }
+
+    governance.Clear();
+}
+
+BOOST_AUTO_TEST_CASE(pending_votes_duplicates)
+{
+    auto vecMasternodes = RegisterMasternodes(*this, 2);
+    uint256 nParentHash = CreateProposal().GetHash();
+
+    CKey otherKey;
+    otherKey.MakeNewKey(true);
+    CBLSSecretKey otherOperatorKey;
+    otherOperatorKey.MakeNewKey();
+
+    // both peers relay the same valid votes
+    auto voteFunding = CreateVotingKeyVote(vecMasternodes[0], nParentHash, vecMasternodes[0].votingKey);
+    auto voteValid = CreateOperatorKeyVote(vecMasternodes[0], nParentHash, vecMasternodes[0].operatorKey);
+    for (NodeId nodeId : {0, 1}) {
+        TestGovernanceManager::QueueVote(nodeId, voteFunding);
+        TestGovernanceManager::QueueVote(nodeId, voteValid);
+    }
+
+    // the peer processed first sends copies with bad signatures, the other peer the valid ones
+    auto voteFunding2 = CreateVotingKeyVote(vecMasternodes[1], nParentHash, vecMasternodes[1].votingKey);
+    auto voteFunding2Bad = voteFunding2;
+    voteFunding2Bad.SetSignature(CreateVotingKeyVote(vecMasternodes[1], nParentHash, otherKey).GetSignature());
+    auto voteValid2 = CreateOperatorKeyVote(vecMasternodes[1], nParentHash, vecMasternodes[1].operatorKey);
+    auto voteValid2Bad = voteValid2;
+    voteValid2Bad.SetSignature(CreateOperatorKeyVote(vecMasternodes[1], nParentHash, otherOperatorKey).GetSignature());
+    BOOST_REQUIRE(voteFunding2Bad.GetHash() == voteFunding2.GetHash());
+    BOOST_REQUIRE(voteValid2Bad.GetHash() == voteValid2.GetHash());
+    TestGovernanceManager::QueueVote(0, voteFunding2Bad);
+    TestGovernanceManager::QueueVote(0, voteValid2Bad);
+    TestGovernanceManager::QueueVote(1, voteFunding2);
+    TestGovernanceManager::QueueVote(1, voteValid2);
+
+    governance.ProcessPendingVotes(*connman);
+
+    for (const auto& vote : {voteFunding, voteValid, voteFunding2, voteValid2}) {
+        BOOST_CHECK(governance.HaveVoteForHash(vote.GetHash()));
+        BOOST_CHECK(!TestGovernanceManager::IsInvalidVote(vote));
+    }
+
+    // a bad copy of a vote that is already known is ignored
+    TestGovernanceManager::QueueVote(0, voteFunding2Bad);
+    governance.ProcessPendingVotes(*connman);
+    BOOST_CHECK(governance.HaveVoteForHash(voteFunding2.GetHash()));
+    BOOST_CHECK(!TestGovernanceManager::IsInvalidVote(voteFunding2));
+
+    governance.Clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,8 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "hash.h"
+#include "clientversion.h"
+#include "streams.h"
 #include "utilstrencodings.h"
 #include "test/test_ion.h"
 
@@ -150,4 +152,28 @@ BOOST_AUTO_TEST_CASE(siphash)
     BOOST_CHECK_EQUAL(SipHashUint256(1, 2, ss.GetHash()), 0x79751e980c2a0a35ULL);
 }
 
+BOOST_AUTO_TEST_CASE(hashed_source_writer)
+{
+    std::vector<unsigned char> vchData = ParseHex("00112233445566778899aabbccddeeff");
+    std::string strMagic = "magicTest";
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    CHashedSourceWriter<CDataStream> writer(&ss);
+    writer << strMagic << vchData;
+    uint256 hash = writer.GetHash();
+
+    // The checksum covers exactly the bytes written to the underlying stream
+    BOOST_CHECK(hash == Hash(ss.begin(), ss.end()));
+
+    // and is the one a CHashVerifier computes when reading them back
+    CHashVerifier<CDataStream> verifier(&ss);
+    std::string strMagicRead;
+    std::vector<unsigned char> vchDataRead;
+    verifier >> strMagicRead >> vchDataRead;
+    BOOST_CHECK_EQUAL(strMagicRead, strMagic);
+    BOOST_CHECK(vchDataRead == vchData);
+    BOOST_CHECK(verifier.GetHash() == hash);
+    BOOST_CHECK(ss.empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "rpc/jsonwriter.h"
 #include "rpc/server.h"
 #include "rpc/client.h"
 
@@ -346,4 +347,61 @@ BOOST_AUTO_TEST_CASE(rpc_convert_values_generatetoaddress)
 }
 #endif // ENABLE_MINER
 
+BOOST_AUTO_TEST_CASE(rpc_json_writer)
+{
+    UniValue fields(UniValue::VOBJ);
+    fields.push_back(Pair("hash", "00ff"));
+    fields.push_back(Pair("height", 42));
+
+    UniValue tx(UniValue::VOBJ);
+    tx.push_back(Pair("txid", "a\"b"));
+
+    UniValue expected(UniValue::VOBJ);
+    expected.pushKVs(fields);
+    UniValue txs(UniValue::VARR);
+    txs.push_back(tx);
+    txs.push_back(tx);
+    expected.push_back(Pair("tx", txs));
+    expected.push_back(Pair("empty", UniValue(UniValue::VARR)));
+    expected.push_back(Pair("chainlock", false));
+
+    // A flush size of one passes every write to the sink on its own
+    std::string strOutput;
+    size_t nChunks = 0;
+    CJSONWriter writer([&](const std::string& strChunk) { strOutput += strChunk; nChunks++; return true; }, 1);
+    BOOST_CHECK(writer.IsEmpty());
+    writer.BeginObject();
+    writer.Fields(fields);
+    writer.Key("tx");
+    writer.BeginArray();
+    writer.Value(tx);
+    writer.Value(tx);
+    writer.EndArray();
+    writer.Key("empty");
+    writer.BeginArray();
+    writer.EndArray();
+    writer.Key("chainlock");
+    writer.Value(false);
+    writer.EndObject();
+    writer.Flush();
+
+    BOOST_CHECK(!writer.IsEmpty());
+    BOOST_CHECK(nChunks > 1);
+    BOOST_CHECK_EQUAL(strOutput, expected.write());
+
+    // Nothing reaches the sink before the flush size is reached
+    strOutput.clear();
+    CJSONWriter bufferedWriter([&](const std::string& strChunk) { strOutput += strChunk; return true; });
+    bufferedWriter.Value(expected);
+    BOOST_CHECK(strOutput.empty());
+    bufferedWriter.Flush();
+    BOOST_CHECK_EQUAL(strOutput, expected.write());
+
+    // A sink that refuses output stops the producer
+    nChunks = 0;
+    CJSONWriter closedWriter([&](const std::string& strChunk) { nChunks++; return false; }, 1);
+    BOOST_CHECK_THROW(closedWriter.BeginArray(), CJSONWriterClosed);
+    BOOST_CHECK_EQUAL(nChunks, 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -112,6 +112,17 @@ struct TestChainDIP3BeforeActivationSetup : public TestChainSetup
     TestChainDIP3BeforeActivationSetup() : TestChainSetup(430) {}
 };
 
+// Outputs of TestChainSetup::coinbaseTxns with the height of their block, for funding transactions
+typedef std::map<COutPoint, std::pair<int, CAmount>> SimpleUTXOMap;
+
+SimpleUTXOMap BuildSimpleUtxoMap(const std::vector<CTransaction>& txs);
+// Takes mature outputs out of utxos until amount is reached
+std::vector<COutPoint> SelectUTXOs(SimpleUTXOMap& utxos, CAmount amount, CAmount& changeRet);
+// Adds inputs for amount, an output of amount to scriptPayout and the change to the same script
+void FundTransaction(CMutableTransaction& tx, SimpleUTXOMap& utxos, const CScript& scriptPayout, CAmount amount);
+// Signs all inputs of tx, they must spend coinbase outputs of coinbaseKey
+void SignTransaction(CMutableTransaction& tx, const CKey& coinbaseKey);
+
 class CTxMemPoolEntry;
 
 struct TestMemPoolEntryHelper
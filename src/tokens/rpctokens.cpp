@@ -10,6 +10,7 @@
 #include "rpc/protocol.h"
 #include "rpc/server.h"
 #include "script/tokengroup.h"
+#include "tokens/tokendb.h"
 #include "tokens/tokengroupmanager.h"
 #include "utilmoneystr.h"
 #include "validation.h"
@@ -627,6 +628,218 @@ UniValue createrawtokentransaction(const JSONRPCRequest& request)
     return EncodeHexTx(rawTx);
 }
 
+static CTokenGroupID ParseTokenIndexGroupID(const UniValue& param)
+{
+    if (!fTokenIndex) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Token index not enabled (-tokenindex)");
+    }
+    CTokenGroupID grpID = GetTokenGroup(param.get_str());
+    if (!grpID.isUserGroup()) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, "Invalid parameter: No group specified");
+    }
+    return grpID;
+}
+
+static std::string TokenIndexAddressToString(unsigned int type, const uint160& hash)
+{
+    if (type == 2) {
+        return CBitcoinAddress(CScriptID(hash)).ToString();
+    } else if (type == 1) {
+        return CBitcoinAddress(CKeyID(hash)).ToString();
+    }
+    return "";
+}
+
+extern UniValue gettokenholders(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "gettokenholders \"groupid\"\n"
+            "\nReturns the addresses holding unspent outputs of a token group (requires tokenindex to be enabled).\n"
+            "\nArguments:\n"
+            "1. \"groupid\"                (string, required) the token group identifier\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"address\" : \"address\",    (string) the holder address\n"
+            "    \"tokenAmount\" : xxx,      (numeric) the token amount held by the address\n"
+            "    \"tokenAmountSat\" : xxx,   (numeric) the token amount held by the address in satoshis\n"
+            "    \"tokenAuthorities\" : \"xxx\" (string) the authorities held by the address\n"
+            "    \"utxos\" : n               (numeric) the number of unspent token outputs held by the address\n"
+            "  }\n"
+            "  ,...\n"
+            "]\n"
+            "\nExamples:\n" +
+            HelpExampleCli("gettokenholders", "\"ion1zwm0kzlyptdmwy3849fd6z5epesnjkruqlwlv02u7y6ymf75nk4qs6u85re\"") +
+            HelpExampleRpc("gettokenholders", "\"ion1zwm0kzlyptdmwy3849fd6z5epesnjkruqlwlv02u7y6ymf75nk4qs6u85re\"")
+        );
+
+    CTokenGroupID grpID = ParseTokenIndexGroupID(request.params[0]);
+
+    std::vector<std::pair<CTokenIndexKey, CTokenIndexValue> > tokenIndex;
+    if (!pTokenDB->ReadTokenIndex(grpID, tokenIndex)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read token index");
+    }
+
+    struct CTokenHolding {
+        CAmount nAmount = 0;
+        GroupAuthorityFlags authorities = GroupAuthorityFlags::NONE;
+        int nOutputs = 0;
+    };
+    std::map<std::string, CTokenHolding> mapHoldings;
+    for (const auto& entry : tokenIndex) {
+        CTokenHolding& holding = mapHoldings[TokenIndexAddressToString(entry.second.addressType, entry.second.addressHash)];
+        holding.nAmount += entry.second.tokenAmount;
+        holding.authorities |= entry.second.GetAuthorityFlags();
+        holding.nOutputs++;
+    }
+
+    std::vector<std::pair<std::string, CTokenHolding> > vHoldings(mapHoldings.begin(), mapHoldings.end());
+    std::sort(vHoldings.begin(), vHoldings.end(), [](const std::pair<std::string, CTokenHolding>& a, const std::pair<std::string, CTokenHolding>& b) {
+        return a.second.nAmount > b.second.nAmount;
+    });
+
+    UniValue ret(UniValue::VARR);
+    for (const auto& holding : vHoldings) {
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("address", holding.first.empty() ? "nonstandard" : holding.first);
+        entry.pushKV("tokenAmount", tokenGroupManager->TokenValueFromAmount(holding.second.nAmount, grpID));
+        entry.pushKV("tokenAmountSat", holding.second.nAmount);
+        if (holding.second.authorities != GroupAuthorityFlags::NONE) {
+            entry.pushKV("tokenAuthorities", EncodeGroupAuthority(holding.second.authorities));
+        }
+        entry.pushKV("utxos", holding.second.nOutputs);
+        ret.push_back(entry);
+    }
+    return ret;
+}
+
+extern UniValue gettokensupply(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "gettokensupply \"groupid\"\n"
+            "\nReturns the circulating supply of a token group (requires tokenindex to be enabled).\n"
+            "\nArguments:\n"
+            "1. \"groupid\"                (string, required) the token group identifier\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"groupID\" : \"groupid\",      (string) the token group identifier\n"
+            "  \"ticker\" : \"ticker\",        (string) the token ticker\n"
+            "  \"supply\" : xxx,             (numeric) the total amount of unspent tokens\n"
+            "  \"supplySat\" : xxx,          (numeric) the total amount of unspent tokens in satoshis\n"
+            "  \"tokenAuthorities\" : \"xxx\"  (string) the authorities that are held by unspent outputs\n"
+            "  \"utxos\" : n,                (numeric) the number of unspent token outputs\n"
+            "  \"holders\" : n               (numeric) the number of addresses holding unspent token outputs\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("gettokensupply", "\"ion1zwm0kzlyptdmwy3849fd6z5epesnjkruqlwlv02u7y6ymf75nk4qs6u85re\"") +
+            HelpExampleRpc("gettokensupply", "\"ion1zwm0kzlyptdmwy3849fd6z5epesnjkruqlwlv02u7y6ymf75nk4qs6u85re\"")
+        );
+
+    CTokenGroupID grpID = ParseTokenIndexGroupID(request.params[0]);
+
+    std::vector<std::pair<CTokenIndexKey, CTokenIndexValue> > tokenIndex;
+    if (!pTokenDB->ReadTokenIndex(grpID, tokenIndex)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read token index");
+    }
+
+    CAmount nSupply = 0;
+    GroupAuthorityFlags authorities = GroupAuthorityFlags::NONE;
+    std::set<std::pair<unsigned int, uint160> > setHolders;
+    for (const auto& entry : tokenIndex) {
+        nSupply += entry.second.tokenAmount;
+        authorities |= entry.second.GetAuthorityFlags();
+        setHolders.emplace(entry.second.addressType, entry.second.addressHash);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("groupID", EncodeTokenGroup(grpID));
+    ret.pushKV("ticker", tokenGroupManager->GetTokenGroupTickerByID(grpID));
+    ret.pushKV("supply", tokenGroupManager->TokenValueFromAmount(nSupply, grpID));
+    ret.pushKV("supplySat", nSupply);
+    ret.pushKV("tokenAuthorities", EncodeGroupAuthority(authorities));
+    ret.pushKV("utxos", (int64_t)tokenIndex.size());
+    ret.pushKV("holders", (int64_t)setHolders.size());
+    return ret;
+}
+
+extern UniValue getaddresstokenbalance(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+        throw std::runtime_error(
+            "getaddresstokenbalance \"address\" ( \"groupid\" )\n"
+            "\nReturns the token balances of an address (requires tokenindex to be enabled).\n"
+            "\nArguments:\n"
+            "1. \"address\"                (string, required) the address\n"
+            "2. \"groupid\"                (string, optional) only return the balance of this token group\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"groupID\" : \"groupid\",    (string) the token group identifier\n"
+            "    \"ticker\" : \"ticker\",      (string) the token ticker\n"
+            "    \"balance\" : xxx,          (numeric) the token balance\n"
+            "    \"balanceSat\" : xxx,       (numeric) the token balance in satoshis\n"
+            "    \"tokenAuthorities\" : \"xxx\" (string) the authorities held by the address\n"
+            "    \"utxos\" : n               (numeric) the number of unspent token outputs\n"
+            "  }\n"
+            "  ,...\n"
+            "]\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getaddresstokenbalance", "\"idFcVh28YpxoCdJhiVjmsUn1Cq9rpJ6KP6\"") +
+            HelpExampleRpc("getaddresstokenbalance", "\"idFcVh28YpxoCdJhiVjmsUn1Cq9rpJ6KP6\"")
+        );
+
+    if (!fTokenIndex) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Token index not enabled (-tokenindex)");
+    }
+
+    CBitcoinAddress address(request.params[0].get_str());
+    uint160 hashBytes;
+    int type = 0;
+    if (!address.GetIndexKey(hashBytes, type)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
+    }
+
+    CTokenGroupID grpFilter = NoGroup;
+    if (request.params.size() > 1) {
+        grpFilter = ParseTokenIndexGroupID(request.params[1]);
+    }
+
+    std::vector<std::pair<CTokenAddressIndexKey, CTokenIndexValue> > tokenAddressIndex;
+    if (!pTokenDB->ReadTokenAddressIndex(hashBytes, type, tokenAddressIndex)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read token index");
+    }
+
+    // Entries are ordered by token group
+    UniValue ret(UniValue::VARR);
+    auto it = tokenAddressIndex.begin();
+    while (it != tokenAddressIndex.end()) {
+        const CTokenGroupID grpID = it->first.tokenGroupID;
+        CAmount nBalance = 0;
+        GroupAuthorityFlags authorities = GroupAuthorityFlags::NONE;
+        int nOutputs = 0;
+        for (; it != tokenAddressIndex.end() && it->first.tokenGroupID == grpID; it++) {
+            nBalance += it->second.tokenAmount;
+            authorities |= it->second.GetAuthorityFlags();
+            nOutputs++;
+        }
+        if (grpFilter != NoGroup && grpID != grpFilter) continue;
+
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("groupID", EncodeTokenGroup(grpID));
+        entry.pushKV("ticker", tokenGroupManager->GetTokenGroupTickerByID(grpID));
+        entry.pushKV("balance", tokenGroupManager->TokenValueFromAmount(nBalance, grpID));
+        entry.pushKV("balanceSat", nBalance);
+        if (authorities != GroupAuthorityFlags::NONE) {
+            entry.pushKV("tokenAuthorities", EncodeGroupAuthority(authorities));
+        }
+        entry.pushKV("utxos", nOutputs);
+        ret.push_back(entry);
+    }
+    return ret;
+}
+
 static const CRPCCommand commands[] =
 { //  category              name                         actor (function)            okSafeMode
   //  --------------------- ---------------------------  --------------------------  ----------
@@ -634,6 +847,9 @@ static const CRPCCommand commands[] =
     { "tokens",             "gettokentransaction",       &gettokentransaction,       false, {}  },
     { "tokens",             "getsubgroupid",             &getsubgroupid,             false, {}  },
     { "tokens",             "createrawtokentransaction", &createrawtokentransaction, false, {}  },
+    { "tokens",             "gettokenholders",           &gettokenholders,           false, {"groupid"}  },
+    { "tokens",             "gettokensupply",            &gettokensupply,            false, {"groupid"}  },
+    { "tokens",             "getaddresstokenbalance",    &getaddresstokenbalance,    false, {"address", "groupid"}  },
 };
 
 void RegisterTokensRPCCommands(CRPCTable &tableRPC)
@@ -4,40 +4,45 @@
 
 #include "tokens/tokendb.h"
 #include "tokens/tokengroupmanager.h"
+#include "script/standard.h"
 #include "ui_interface.h"
 #include "validation.h"
 
 #include <boost/thread.hpp>
 
+static const char DB_TOKEN_GROUP = 'c';
+static const char DB_TOKEN_INDEX = 'u';
+static const char DB_TOKEN_ADDRESS_INDEX = 'a';
+
 CTokenDB::CTokenDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "tokens", nCacheSize, fMemory, fWipe) {}
 
 bool CTokenDB::WriteTokenGroupsBatch(const std::vector<CTokenGroupCreation>& tokenGroups) {
     CDBBatch batch(*this);
     for (std::vector<CTokenGroupCreation>::const_iterator it = tokenGroups.begin(); it != tokenGroups.end(); it++){
-        batch.Write(std::make_pair('c', it->tokenGroupInfo.associatedGroup), *it);
+        batch.Write(std::make_pair(DB_TOKEN_GROUP, it->tokenGroupInfo.associatedGroup), *it);
     }
     return WriteBatch(batch);
 }
 
 bool CTokenDB::WriteTokenGroup(const CTokenGroupID& tokenGroupID, const CTokenGroupCreation& tokenGroupCreation) {
-    return Write(std::make_pair('c', tokenGroupID), tokenGroupCreation);
+    return Write(std::make_pair(DB_TOKEN_GROUP, tokenGroupID), tokenGroupCreation);
 }
 
 bool CTokenDB::ReadTokenGroup(const CTokenGroupID& tokenGroupID, CTokenGroupCreation& tokenGroupCreation) {
-    return Read(std::make_pair('c', tokenGroupID), tokenGroupCreation);
+    return Read(std::make_pair(DB_TOKEN_GROUP, tokenGroupID), tokenGroupCreation);
 }
 
 bool CTokenDB::EraseTokenGroupBatch(const std::vector<CTokenGroupID>& newTokenGroupIDs) {
     CDBBatch batch(*this);
     for (std::vector<CTokenGroupID>::const_iterator it = newTokenGroupIDs.begin(); it != newTokenGroupIDs.end(); it++){
-        batch.Erase(std::make_pair('c', *it));
+        batch.Erase(std::make_pair(DB_TOKEN_GROUP, *it));
     }
     return WriteBatch(batch);
 
 }
 
 bool CTokenDB::EraseTokenGroup(const CTokenGroupID& tokenGroupID) {
-    return Erase(std::make_pair('c', tokenGroupID));
+    return Erase(std::make_pair(DB_TOKEN_GROUP, tokenGroupID));
 }
 
 bool CTokenDB::DropTokenGroups(std::string& strError) {
@@ -55,12 +60,12 @@ bool CTokenDB::DropTokenGroups(std::string& strError) {
 
 bool CTokenDB::FindTokenGroups(std::vector<CTokenGroupCreation>& vTokenGroups, std::string& strError) {
     boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
-    pcursor->SeekToFirst();
+    pcursor->Seek(DB_TOKEN_GROUP);
 
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
         std::pair<char, CTokenGroupID> key;
-        if (pcursor->GetKey(key) && key.first == 'c') {
+        if (pcursor->GetKey(key) && key.first == DB_TOKEN_GROUP) {
             CTokenGroupCreation tokenGroupCreation;
             if (pcursor->GetValue(tokenGroupCreation)) {
                 vTokenGroups.push_back(tokenGroupCreation);
@@ -68,6 +73,8 @@ bool CTokenDB::FindTokenGroups(std::vector<CTokenGroupCreation>& vTokenGroups, s
                 strError = "Failed to read token data from database";
                 return error(strError.c_str());
             }
+        } else {
+            break;
         }
         pcursor->Next();
     }
@@ -84,6 +91,97 @@ bool CTokenDB::LoadTokensFromDB(std::string& strError) {
     return true;
 }
 
+bool CTokenDB::UpdateTokenIndex(const std::vector<std::pair<CTokenIndexKey, CTokenIndexValue> >& vect) {
+    CDBBatch batch(*this);
+    for (std::vector<std::pair<CTokenIndexKey, CTokenIndexValue> >::const_iterator it = vect.begin(); it != vect.end(); it++) {
+        const CTokenIndexKey& key = it->first;
+        const CTokenIndexValue& value = it->second;
+        CTokenAddressIndexKey addressKey(value.addressType, value.addressHash, key.tokenGroupID, key.txhash, key.index);
+        if (value.IsNull()) {
+            batch.Erase(std::make_pair(DB_TOKEN_INDEX, key));
+            if (value.addressType > 0) {
+                batch.Erase(std::make_pair(DB_TOKEN_ADDRESS_INDEX, addressKey));
+            }
+        } else {
+            batch.Write(std::make_pair(DB_TOKEN_INDEX, key), value);
+            if (value.addressType > 0) {
+                batch.Write(std::make_pair(DB_TOKEN_ADDRESS_INDEX, addressKey), value);
+            }
+        }
+    }
+    return WriteBatch(batch);
+}
+
+bool CTokenDB::ReadTokenIndex(const CTokenGroupID& tokenGroupID, std::vector<std::pair<CTokenIndexKey, CTokenIndexValue> >& vect) {
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(DB_TOKEN_INDEX, tokenGroupID));
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, CTokenIndexKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_TOKEN_INDEX && key.second.tokenGroupID == tokenGroupID) {
+            CTokenIndexValue value;
+            if (pcursor->GetValue(value)) {
+                vect.push_back(std::make_pair(key.second, value));
+                pcursor->Next();
+            } else {
+                return error("failed to get token index value");
+            }
+        } else {
+            break;
+        }
+    }
+    return true;
+}
+
+bool CTokenDB::ReadTokenAddressIndex(const uint160& addressHash, int type, std::vector<std::pair<CTokenAddressIndexKey, CTokenIndexValue> >& vect) {
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(DB_TOKEN_ADDRESS_INDEX, CTokenAddressIndexIteratorKey(type, addressHash)));
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, CTokenAddressIndexKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_TOKEN_ADDRESS_INDEX && key.second.type == (unsigned int)type && key.second.hashBytes == addressHash) {
+            CTokenIndexValue value;
+            if (pcursor->GetValue(value)) {
+                vect.push_back(std::make_pair(key.second, value));
+                pcursor->Next();
+            } else {
+                return error("failed to get token address index value");
+            }
+        } else {
+            break;
+        }
+    }
+    return true;
+}
+
+bool GetTokenIndexEntry(const CTxOut& txout, const uint256& txhash, unsigned int n, int nHeight, CTokenIndexKey& key, CTokenIndexValue& value) {
+    CTokenGroupInfo tgInfo(txout.scriptPubKey);
+    if (tgInfo.invalid || tgInfo.associatedGroup == NoGroup) {
+        return false;
+    }
+
+    unsigned int addressType = 0;
+    uint160 addressHash;
+    CTxDestination dest;
+    if (ExtractDestination(txout.scriptPubKey, dest)) {
+        if (const CKeyID* keyID = boost::get<CKeyID>(&dest)) {
+            addressType = 1;
+            addressHash = *keyID;
+        } else if (const CScriptID* scriptID = boost::get<CScriptID>(&dest)) {
+            addressType = 2;
+            addressHash = *scriptID;
+        }
+    }
+
+    key = CTokenIndexKey(tgInfo.associatedGroup, txhash, n);
+    value = CTokenIndexValue(tgInfo, txout.nValue, txout.scriptPubKey, addressType, addressHash, nHeight);
+    return true;
+}
+
 bool VerifyTokenDB(std::string &strError) {
     std::vector<CTokenGroupCreation> vTokenGroups;
     if (!pTokenDB->FindTokenGroups(vTokenGroups, strError)) {
@@ -6,11 +6,13 @@
 #define ION_CTOKENDB_H
 
 #include "dbwrapper.h"
+#include "tokens/tokenindex.h"
 
 #include <boost/filesystem/path.hpp>
 
 class CTokenGroupCreation;
 class CTokenGroupID;
+class CTxOut;
 
 class CTokenDB : public CDBWrapper
 {
@@ -31,8 +33,16 @@ public:
     bool DropTokenGroups(std::string& strError);
     bool FindTokenGroups(std::vector<CTokenGroupCreation>& vTokenGroups, std::string& strError);
     bool LoadTokensFromDB(std::string& strError); // populates mapTokenGroups
+
+    /** Add and remove unspent grouped outputs from the token index (-tokenindex), applied in order. Spent values are erased */
+    bool UpdateTokenIndex(const std::vector<std::pair<CTokenIndexKey, CTokenIndexValue> >& vect);
+    bool ReadTokenIndex(const CTokenGroupID& tokenGroupID, std::vector<std::pair<CTokenIndexKey, CTokenIndexValue> >& vect);
+    bool ReadTokenAddressIndex(const uint160& addressHash, int type, std::vector<std::pair<CTokenAddressIndexKey, CTokenIndexValue> >& vect);
 };
 
+// Returns false if the output is not grouped; otherwise fills in the token index entry of the output
+bool GetTokenIndexEntry(const CTxOut& txout, const uint256& txhash, unsigned int n, int nHeight, CTokenIndexKey& key, CTokenIndexValue& value);
+
 bool ReindexTokenDB(std::string &strError); // Drops db, scans for token creations, but does not populate mapTokenGroups
 bool VerifyTokenDB(std::string &strError); // Fetches all tokens from the DB and verifies that their configuration transactions are valid
 
@@ -14,6 +14,8 @@
 #include "tokens/tokengroupconfiguration.h"
 
 CTokenGroupManager::CTokenGroupManager() {
+    tokenManagementKeyDest = DecodeDestination(Params().GetConsensus().strTokenManagementKey);
+
     vTokenGroupFilters.emplace_back(TGFilterCharacters);
     vTokenGroupFilters.emplace_back(TGFilterUniqueness);
     vTokenGroupFilters.emplace_back(TGFilterUpperCaseTicker);
@@ -192,11 +194,11 @@ uint16_t CTokenGroupManager::GetXDMInBlock(const CBlock& block) {
         CTokenGroupID tgId = tokenGroupManager->GetDarkMatterID();
         for (unsigned int i = 0; i < block.vtx.size(); i++)
         {
-            for (const auto &outp : block.vtx[i]->vout)
+            const uint256& txhash = block.vtx[i]->GetHash();
+            for (unsigned int j = 0; j < block.vtx[i]->vout.size(); j++)
             {
-                const CScript &scriptPubKey = outp.scriptPubKey;
-                CTokenGroupInfo tokenGrp(scriptPubKey);
-                if (!tokenGrp.invalid && tokenGrp.associatedGroup == tgId)
+                const CTokenGroupInfoRef tokenGrp = tokenGroupInfoCache.Get(COutPoint(txhash, j), block.vtx[i]->vout[j].scriptPubKey);
+                if (!tokenGrp->invalid && tokenGrp->associatedGroup == tgId)
                 {
                     nXDMCount++;
                     break;
@@ -214,13 +216,13 @@ unsigned int CTokenGroupManager::GetTokenTxStats(const CTransactionRef &tx, cons
     CAmount nTxValueIn = 0;
 
     if (!tx->IsCoinBase() && !tx->IsCoinStake() && !tx->HasZerocoinSpendInputs()) {
-        for (const auto &outp : tx->vout)
+        const uint256& txhash = tx->GetHash();
+        for (unsigned int i = 0; i < tx->vout.size(); i++)
         {
-            const CScript &scriptPubKey = outp.scriptPubKey;
-            CTokenGroupInfo tokenGrp(scriptPubKey);
-            if (!tokenGrp.invalid && tokenGrp.associatedGroup == tgId && !tokenGrp.isAuthority())
+            const CTokenGroupInfoRef tokenGrp = tokenGroupInfoCache.Get(COutPoint(txhash, i), tx->vout[i].scriptPubKey);
+            if (!tokenGrp->invalid && tokenGrp->associatedGroup == tgId && !tokenGrp->isAuthority())
             {
-                nTxValueOut += tokenGrp.quantity;
+                nTxValueOut += tokenGrp->quantity;
             }
         }
         for (const auto &inp : tx->vin)
@@ -230,12 +232,10 @@ unsigned int CTokenGroupManager::GetTokenTxStats(const CTransactionRef &tx, cons
 
             if (coin.nHeight < Params().GetConsensus().ATPStartHeight)
                 continue;
-            const CScript &script = coin.out.scriptPubKey;
-
-            CTokenGroupInfo tokenGrp(script);
-            if (!tokenGrp.invalid && tokenGrp.associatedGroup == tgId && !tokenGrp.isAuthority())
+            const CTokenGroupInfoRef tokenGrp = tokenGroupInfoCache.Get(prevout, coin.out.scriptPubKey);
+            if (!tokenGrp->invalid && tokenGrp->associatedGroup == tgId && !tokenGrp->isAuthority())
             {
-                nTxValueIn += tokenGrp.quantity;
+                nTxValueIn += tokenGrp->quantity;
             }
         }
         nTokenMint += nTxValueOut - nTxValueIn;
@@ -338,16 +338,18 @@ bool CTokenGroupManager::CheckXDMFees(const CTransaction &tx, const std::unorder
 
     nXDMFees = 0;
 
-    for (auto txout : tx.vout) {
-        CTokenGroupInfo grp(txout.scriptPubKey);
-        if (grp.invalid)
+    const uint256& txhash = tx.GetHash();
+    for (unsigned int i = 0; i < tx.vout.size(); i++) {
+        const CTxOut& txout = tx.vout[i];
+        const CTokenGroupInfoRef grp = tokenGroupInfoCache.Get(COutPoint(txhash, i), txout.scriptPubKey);
+        if (grp->invalid)
             return false;
-        if (grp.isGroupCreation() && !grp.associatedGroup.hasFlag(TokenGroupIdFlags::MGT_TOKEN)) {
+        if (grp->isGroupCreation() && !grp->associatedGroup.hasFlag(TokenGroupIdFlags::MGT_TOKEN)) {
             // Creation tx of regular token
             nXDMFees = 5 * curXDMFee;
             nXDMFreeOutputs = nXDMFreeOutputs < 2 ? 2 : nXDMFreeOutputs; // Free outputs for fee and change
         }
-        if (MatchesDarkMatter(grp.associatedGroup) && !grp.isAuthority()) {
+        if (MatchesDarkMatter(grp->associatedGroup) && !grp->isAuthority()) {
             // XDM output (send or mint)
             nXDMOutputs++;
 
@@ -356,7 +358,7 @@ bool CTokenGroupManager::CheckXDMFees(const CTransaction &tx, const std::unorder
             CTxDestination payeeDest;
             ExtractDestination(txout.scriptPubKey, payeeDest);
             if (EncodeDestination(payeeDest) == Params().GetConsensus().strTokenManagementKey) {
-                XDMFeesPaid += grp.quantity;
+                XDMFeesPaid += grp->quantity;
             }
         }
     }
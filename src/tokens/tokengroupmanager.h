@@ -6,6 +6,7 @@
 #define TOKEN_GROUP_MANAGER_H
 
 #include "consensus/tokengroups.h"
+#include "script/standard.h"
 #include "tokens/tokengroupconfiguration.h"
 
 #include <unordered_map>
@@ -27,6 +28,9 @@ private:
     std::unique_ptr<CTokenGroupCreation> tgAtomCreation;
     std::unique_ptr<CTokenGroupCreation> tgElectronCreation;
 
+    // Decoded consensus token management key, compared against input destinations
+    CTxDestination tokenManagementKeyDest;
+
 public:
     CTokenGroupManager();
 
@@ -62,6 +66,7 @@ public:
     bool ElectronTokensCreated() { return tgElectronCreation ? true : false; };
 
     bool ManagementTokensCreated(int nHeight);
+    const CTxDestination& GetTokenManagementKeyDest() const { return tokenManagementKeyDest; };
 
     uint16_t GetXDMInBlock(const CBlock& block);
     unsigned int GetTokenTxStats(const CTransactionRef &tx, const CCoinsViewCache& view, const CTokenGroupID &tgId, uint16_t &nTokenCount, CAmount &nTokenMint);
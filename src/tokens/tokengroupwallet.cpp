@@ -57,8 +57,8 @@ OP_HASH256 [32-byte-hash-value] OP_EQUAL
 void GetAllGroupBalances(const CWallet *wallet, std::unordered_map<CTokenGroupID, CAmount> &balances)
 {
     std::vector<COutput> coins;
-    wallet->FilterCoins(coins, [&balances](const CWalletTx *tx, const CTxOut *out) {
-        CTokenGroupInfo tg(out->scriptPubKey);
+    wallet->FilterGroupedCoins(coins, nullptr, [&balances](const CWalletTx *tx, const CTxOut *out, const CTokenLedgerEntry &entry) {
+        const CTokenGroupInfo &tg = entry.tokenGroupInfo;
         if ((tg.associatedGroup != NoGroup) && !tg.isAuthority()) // must be sitting in any group address
         {
             if (tg.quantity > std::numeric_limits<CAmount>::max() - balances[tg.associatedGroup])
@@ -73,8 +73,8 @@ void GetAllGroupBalances(const CWallet *wallet, std::unordered_map<CTokenGroupID
 void GetAllGroupBalancesAndAuthorities(const CWallet *wallet, std::unordered_map<CTokenGroupID, CAmount> &balances, std::unordered_map<CTokenGroupID, GroupAuthorityFlags> &authorities)
 {
     std::vector<COutput> coins;
-    wallet->FilterCoins(coins, [&balances, &authorities](const CWalletTx *tx, const CTxOut *out) {
-        CTokenGroupInfo tg(out->scriptPubKey);
+    wallet->FilterGroupedCoins(coins, nullptr, [&balances, &authorities](const CWalletTx *tx, const CTxOut *out, const CTokenLedgerEntry &entry) {
+        const CTokenGroupInfo &tg = entry.tokenGroupInfo;
         if ((tg.associatedGroup != NoGroup)) {
             authorities[tg.associatedGroup] |= tg.controllingGroupFlags();
             if (!tg.isAuthority()) {
@@ -91,53 +91,35 @@ void GetAllGroupBalancesAndAuthorities(const CWallet *wallet, std::unordered_map
 }
 
 void ListAllGroupAuthorities(const CWallet *wallet, std::vector<COutput> &coins) {
-    wallet->FilterCoins(coins, [](const CWalletTx *tx, const CTxOut *out) {
-        CTokenGroupInfo tg(out->scriptPubKey);
-        if (tg.isAuthority()) {
-            return true;
-        } else {
-            return false;
-        }
+    wallet->FilterGroupedCoins(coins, nullptr, [](const CWalletTx *tx, const CTxOut *out, const CTokenLedgerEntry &entry) {
+        return entry.tokenGroupInfo.isAuthority();
     });
 }
 
 void ListGroupAuthorities(const CWallet *wallet, std::vector<COutput> &coins, const CTokenGroupID &grpID) {
-    wallet->FilterCoins(coins, [grpID](const CWalletTx *tx, const CTxOut *out) {
-        CTokenGroupInfo tg(out->scriptPubKey);
-        if (tg.isAuthority() && tg.associatedGroup == grpID) {
-            return true;
-        } else {
-            return false;
-        }
+    wallet->FilterGroupedCoins(coins, &grpID, [](const CWalletTx *tx, const CTxOut *out, const CTokenLedgerEntry &entry) {
+        return entry.tokenGroupInfo.isAuthority();
     });
 }
 
+// Whether a ledger entry is sitting on dest, any destination matches CNoDestination
+static bool MatchesDestination(const CTokenLedgerEntry &entry, const CTxDestination &dest)
+{
+    return dest == CTxDestination(CNoDestination()) || entry.dest == dest;
+}
+
 CAmount GetGroupBalance(const CTokenGroupID &grpID, const CTxDestination &dest, const CWallet *wallet)
 {
     std::vector<COutput> coins;
     CAmount balance = 0;
-    wallet->FilterCoins(coins, [grpID, dest, &balance](const CWalletTx *tx, const CTxOut *out) {
-        CTokenGroupInfo tg(out->scriptPubKey);
-        if ((grpID == tg.associatedGroup) && !tg.isAuthority()) // must be sitting in group address
+    wallet->FilterGroupedCoins(coins, &grpID, [dest, &balance](const CWalletTx *tx, const CTxOut *out, const CTokenLedgerEntry &entry) {
+        const CTokenGroupInfo &tg = entry.tokenGroupInfo;
+        if (!tg.isAuthority() && MatchesDestination(entry, dest)) // must be sitting in group address
         {
-            bool useit = dest == CTxDestination(CNoDestination());
-            if (!useit)
-            {
-                CTxDestination address;
-                txnouttype whichType;
-                if (ExtractDestinationAndType(out->scriptPubKey, address, whichType))
-                {
-                    if (address == dest)
-                        useit = true;
-                }
-            }
-            if (useit)
-            {
-                if (tg.quantity > std::numeric_limits<CAmount>::max() - balance)
-                    balance = std::numeric_limits<CAmount>::max();
-                else
-                    balance += tg.quantity;
-            }
+            if (tg.quantity > std::numeric_limits<CAmount>::max() - balance)
+                balance = std::numeric_limits<CAmount>::max();
+            else
+                balance += tg.quantity;
         }
         return false;
     });
@@ -149,32 +131,16 @@ void GetGroupBalanceAndAuthorities(CAmount &balance, GroupAuthorityFlags &author
     std::vector<COutput> coins;
     balance = 0;
     authorities = GroupAuthorityFlags::NONE;
-    wallet->FilterCoins(coins, [grpID, dest, &balance, &authorities](const CWalletTx *tx, const CTxOut *out) {
-        CTokenGroupInfo tg(out->scriptPubKey);
-        if ((grpID == tg.associatedGroup)) // must be sitting in group address
+    wallet->FilterGroupedCoins(coins, &grpID, [dest, &balance, &authorities](const CWalletTx *tx, const CTxOut *out, const CTokenLedgerEntry &entry) {
+        const CTokenGroupInfo &tg = entry.tokenGroupInfo;
+        if (MatchesDestination(entry, dest)) // must be sitting in group address
         {
-            bool useit = dest == CTxDestination(CNoDestination());
-            if (!useit)
-            {
-                CTxDestination address;
-                txnouttype whichType;
-                if (ExtractDestinationAndType(out->scriptPubKey, address, whichType))
-                {
-                    if (address == dest)
-                        useit = true;
-                }
-            }
-            if (useit)
-            {
-                authorities |= tg.controllingGroupFlags();
-                if (!tg.isAuthority()) {
-                    if (tg.quantity > std::numeric_limits<CAmount>::max() - balance)
-                        balance = std::numeric_limits<CAmount>::max();
-                    else
-                        balance += tg.quantity;
-                } else {
-                    balance += 0;
-                }
+            authorities |= tg.controllingGroupFlags();
+            if (!tg.isAuthority()) {
+                if (tg.quantity > std::numeric_limits<CAmount>::max() - balance)
+                    balance = std::numeric_limits<CAmount>::max();
+                else
+                    balance += tg.quantity;
             }
         }
         return false;
@@ -182,26 +148,16 @@ void GetGroupBalanceAndAuthorities(CAmount &balance, GroupAuthorityFlags &author
 }
 
 void GetGroupCoins(const CWallet *wallet, std::vector<COutput>& coins, CAmount& balance, const CTokenGroupID &grpID, const CTxDestination &dest) {
-    wallet->FilterCoins(coins, [dest, grpID, &balance](const CWalletTx *tx, const CTxOut *out) {
-        CTokenGroupInfo tg(out->scriptPubKey);
-        if ((grpID == tg.associatedGroup) && !tg.isAuthority()) {
-            bool useit = dest == CTxDestination(CNoDestination());
-            if (!useit) {
-                CTxDestination address;
-                txnouttype whichType;
-                if (ExtractDestinationAndType(out->scriptPubKey, address, whichType)) {
-                    if (address == dest)
-                        useit = true;
-                }
-            }
-            if (useit) {
-                if (tg.quantity > std::numeric_limits<CAmount>::max() - balance) {
-                    balance = std::numeric_limits<CAmount>::max();
-                } else {
-                    balance += tg.quantity;
-                }
-                return true;
+    // The ledger visits the outputs of a group largest first, so GroupCoinSelection needs the fewest inputs
+    wallet->FilterGroupedCoins(coins, &grpID, [dest, &balance](const CWalletTx *tx, const CTxOut *out, const CTokenLedgerEntry &entry) {
+        const CTokenGroupInfo &tg = entry.tokenGroupInfo;
+        if (!tg.isAuthority() && MatchesDestination(entry, dest)) {
+            if (tg.quantity > std::numeric_limits<CAmount>::max() - balance) {
+                balance = std::numeric_limits<CAmount>::max();
+            } else {
+                balance += tg.quantity;
             }
+            return true;
         }
         return false;
     });
@@ -212,23 +168,9 @@ void GetGroupAuthority(const CWallet *wallet, std::vector<COutput>& coins, Group
     // Todo:
     // - Find the coin with the minimum amount of authorities
     // - If needed, combine coins to provide the requested authorities
-    wallet->FilterCoins(coins, [flags, dest, grpID](const CWalletTx *tx, const CTxOut *out) {
-        CTokenGroupInfo tg(out->scriptPubKey);
-        if ((grpID == tg.associatedGroup) && tg.isAuthority() && hasCapability(tg.controllingGroupFlags(), flags)) {
-            bool useit = dest == CTxDestination(CNoDestination());
-            if (!useit) {
-                CTxDestination address;
-                txnouttype whichType;
-                if (ExtractDestinationAndType(out->scriptPubKey, address, whichType)) {
-                    if (address == dest)
-                        useit = true;
-                }
-            }
-            if (useit) {
-                return true;
-            }
-        }
-        return false;
+    wallet->FilterGroupedCoins(coins, &grpID, [flags, dest](const CWalletTx *tx, const CTxOut *out, const CTokenLedgerEntry &entry) {
+        const CTokenGroupInfo &tg = entry.tokenGroupInfo;
+        return tg.isAuthority() && hasCapability(tg.controllingGroupFlags(), flags) && MatchesDestination(entry, dest);
     });
 }
 
@@ -423,8 +365,8 @@ void GroupMelt(CWalletTx &wtxNew, const CTokenGroupID &grpID, CAmount totalNeede
     // Find melt authority
     std::vector<COutput> coins;
 
-    int nOptions = wallet->FilterCoins(coins, [grpID](const CWalletTx *tx, const CTxOut *out) {
-        CTokenGroupInfo tg(out->scriptPubKey);
+    int nOptions = wallet->FilterGroupedCoins(coins, &grpID, [grpID](const CWalletTx *tx, const CTxOut *out, const CTokenLedgerEntry &entry) {
+        const CTokenGroupInfo &tg = entry.tokenGroupInfo;
         if ((tg.associatedGroup == grpID) && tg.allowsMelt())
         {
             return true;
@@ -438,8 +380,9 @@ void GroupMelt(CWalletTx &wtxNew, const CTokenGroupID &grpID, CAmount totalNeede
     if ((nOptions == 0) && (grpID.isSubgroup()))
     {
         // if its a subgroup look for a parent authority that will work
-        nOptions = wallet->FilterCoins(coins, [grpID](const CWalletTx *tx, const CTxOut *out) {
-            CTokenGroupInfo tg(out->scriptPubKey);
+        const CTokenGroupID parentGrpID = grpID.parentGroup();
+        nOptions = wallet->FilterGroupedCoins(coins, &parentGrpID, [grpID](const CWalletTx *tx, const CTxOut *out, const CTokenLedgerEntry &entry) {
+            const CTokenGroupInfo &tg = entry.tokenGroupInfo;
             if (tg.isAuthority() && tg.allowsRenew() && tg.allowsSubgroup() && tg.allowsMelt() &&
                 (tg.associatedGroup == grpID.parentGroup()))
             {
@@ -464,8 +407,8 @@ void GroupMelt(CWalletTx &wtxNew, const CTokenGroupID &grpID, CAmount totalNeede
 
     // Find meltable coins
     coins.clear();
-    wallet->FilterCoins(coins, [grpID](const CWalletTx *tx, const CTxOut *out) {
-        CTokenGroupInfo tg(out->scriptPubKey);
+    wallet->FilterGroupedCoins(coins, &grpID, [grpID](const CWalletTx *tx, const CTxOut *out, const CTokenLedgerEntry &entry) {
+        const CTokenGroupInfo &tg = entry.tokenGroupInfo;
         // must be a grouped output sitting in group address
         return ((grpID == tg.associatedGroup) && !tg.isAuthority());
     });
@@ -512,8 +455,8 @@ void GroupSend(CWalletTx &wtxNew,
     } else {
         if (totalXDMNeeded > 0) {
             CTokenGroupID XDMGrpID = tokenGroupManager->GetDarkMatterID();
-            wallet->FilterCoins(coins, [XDMGrpID, &totalXDMAvailable](const CWalletTx *tx, const CTxOut *out) {
-                CTokenGroupInfo tg(out->scriptPubKey);
+            wallet->FilterGroupedCoins(coins, &XDMGrpID, [XDMGrpID, &totalXDMAvailable](const CWalletTx *tx, const CTxOut *out, const CTokenLedgerEntry &entry) {
+                const CTokenGroupInfo &tg = entry.tokenGroupInfo;
                 if ((XDMGrpID == tg.associatedGroup) && !tg.isAuthority())
                 {
                     totalXDMAvailable += tg.quantity;
@@ -534,8 +477,8 @@ void GroupSend(CWalletTx &wtxNew,
     }
 
     CAmount totalAvailable = 0;
-    wallet->FilterCoins(coins, [grpID, &totalAvailable](const CWalletTx *tx, const CTxOut *out) {
-        CTokenGroupInfo tg(out->scriptPubKey);
+    wallet->FilterGroupedCoins(coins, &grpID, [grpID, &totalAvailable](const CWalletTx *tx, const CTxOut *out, const CTokenLedgerEntry &entry) {
+        const CTokenGroupInfo &tg = entry.tokenGroupInfo;
         if ((grpID == tg.associatedGroup) && !tg.isAuthority())
         {
             totalAvailable += tg.quantity;
@@ -0,0 +1,178 @@
+// Copyright (c) 2020 The Ion Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef ION_TOKENINDEX_H
+#define ION_TOKENINDEX_H
+
+#include "amount.h"
+#include "script/script.h"
+#include "serialize.h"
+#include "tokens/groups.h"
+#include "uint256.h"
+
+/** Key of an unspent grouped output, ordered by token group and then by outpoint */
+struct CTokenIndexKey {
+    CTokenGroupID tokenGroupID;
+    uint256 txhash;
+    unsigned int index;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(tokenGroupID);
+        READWRITE(txhash);
+        READWRITE(index);
+    }
+
+    CTokenIndexKey(const CTokenGroupID& tgID, const uint256& txid, unsigned int indexValue) {
+        tokenGroupID = tgID;
+        txhash = txid;
+        index = indexValue;
+    }
+
+    CTokenIndexKey() {
+        SetNull();
+    }
+
+    void SetNull() {
+        tokenGroupID = NoGroup;
+        txhash.SetNull();
+        index = 0;
+    }
+};
+
+/** Key of an unspent grouped output, ordered by holder address, token group and outpoint */
+struct CTokenAddressIndexKey {
+    unsigned int type;
+    uint160 hashBytes;
+    CTokenGroupID tokenGroupID;
+    uint256 txhash;
+    unsigned int index;
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata8(s, type);
+        hashBytes.Serialize(s);
+        tokenGroupID.Serialize(s);
+        txhash.Serialize(s);
+        ser_writedata32(s, index);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        type = ser_readdata8(s);
+        hashBytes.Unserialize(s);
+        tokenGroupID.Unserialize(s);
+        txhash.Unserialize(s);
+        index = ser_readdata32(s);
+    }
+
+    CTokenAddressIndexKey(unsigned int addressType, const uint160& addressHash, const CTokenGroupID& tgID, const uint256& txid, unsigned int indexValue) {
+        type = addressType;
+        hashBytes = addressHash;
+        tokenGroupID = tgID;
+        txhash = txid;
+        index = indexValue;
+    }
+
+    CTokenAddressIndexKey() {
+        SetNull();
+    }
+
+    void SetNull() {
+        type = 0;
+        hashBytes.SetNull();
+        tokenGroupID = NoGroup;
+        txhash.SetNull();
+        index = 0;
+    }
+};
+
+/** Prefix used to seek to the first token output of an address */
+struct CTokenAddressIndexIteratorKey {
+    unsigned int type;
+    uint160 hashBytes;
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata8(s, type);
+        hashBytes.Serialize(s);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        type = ser_readdata8(s);
+        hashBytes.Unserialize(s);
+    }
+
+    CTokenAddressIndexIteratorKey(unsigned int addressType, const uint160& addressHash) {
+        type = addressType;
+        hashBytes = addressHash;
+    }
+};
+
+struct CTokenIndexValue {
+    CAmount tokenAmount;
+    uint64_t authorityFlags;
+    CAmount satoshis;
+    CScript script;
+    unsigned int addressType;
+    uint160 addressHash;
+    int blockHeight;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(tokenAmount);
+        READWRITE(authorityFlags);
+        READWRITE(satoshis);
+        READWRITE(script);
+        READWRITE(addressType);
+        READWRITE(addressHash);
+        READWRITE(blockHeight);
+    }
+
+    CTokenIndexValue(const CTokenGroupInfo& tgInfo, CAmount sats, const CScript& scriptPubKey, unsigned int type, const uint160& hash, int height) {
+        tokenAmount = tgInfo.getAmount();
+        authorityFlags = (uint64_t)tgInfo.controllingGroupFlags();
+        satoshis = sats;
+        script = scriptPubKey;
+        addressType = type;
+        addressHash = hash;
+        blockHeight = height;
+    }
+
+    CTokenIndexValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        tokenAmount = 0;
+        authorityFlags = 0;
+        satoshis = -1;
+        script.clear();
+        addressType = 0;
+        addressHash.SetNull();
+        blockHeight = 0;
+    }
+
+    // Marks the entry for removal. The address is kept so that the address index entry can be erased as well
+    void SetSpent() {
+        satoshis = -1;
+    }
+
+    bool IsNull() const {
+        return (satoshis == -1);
+    }
+
+    GroupAuthorityFlags GetAuthorityFlags() const {
+        return (GroupAuthorityFlags)authorityFlags;
+    }
+
+    bool IsAuthority() const {
+        return hasCapability(GetAuthorityFlags(), GroupAuthorityFlags::CTRL);
+    }
+};
+
+#endif // ION_TOKENINDEX_H
@@ -0,0 +1,69 @@
+// Copyright (c) 2020 The Ion Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "tokens/tokenledger.h"
+
+void CTokenLedger::Add(const COutPoint& outpoint, const CScript& scriptPubKey)
+{
+    if (mapEntries.count(outpoint))
+        return;
+
+    CTokenGroupInfo tg(scriptPubKey);
+    if (tg.associatedGroup == NoGroup)
+        return;
+
+    CTxDestination dest;
+    txnouttype whichType;
+    if (!ExtractDestinationAndType(scriptPubKey, dest, whichType))
+        dest = CNoDestination();
+
+    mapEntries.emplace(outpoint, CTokenLedgerEntry(tg, dest));
+    mapGroupOutputs[tg.associatedGroup].emplace(tg.quantity, outpoint);
+}
+
+void CTokenLedger::EraseTx(const uint256& hash, unsigned int nOutputs)
+{
+    for (unsigned int i = 0; i < nOutputs; i++) {
+        auto it = mapEntries.find(COutPoint(hash, i));
+        if (it == mapEntries.end())
+            continue;
+
+        const CTokenGroupInfo& tg = it->second.tokenGroupInfo;
+        auto itGroup = mapGroupOutputs.find(tg.associatedGroup);
+        if (itGroup != mapGroupOutputs.end()) {
+            itGroup->second.erase(std::make_pair(tg.quantity, it->first));
+            if (itGroup->second.empty())
+                mapGroupOutputs.erase(itGroup);
+        }
+        mapEntries.erase(it);
+    }
+}
+
+void CTokenLedger::Clear()
+{
+    mapEntries.clear();
+    mapGroupOutputs.clear();
+}
+
+void CTokenLedger::ForEachGroupOutput(const CTokenGroupID& grpID, std::function<bool(const COutPoint&, const CTokenLedgerEntry&)> func) const
+{
+    auto itGroup = mapGroupOutputs.find(grpID);
+    if (itGroup == mapGroupOutputs.end())
+        return;
+
+    for (const auto& output : itGroup->second) {
+        if (!func(output.second, mapEntries.at(output.second)))
+            return;
+    }
+}
+
+void CTokenLedger::ForEachOutput(std::function<bool(const COutPoint&, const CTokenLedgerEntry&)> func) const
+{
+    for (const auto& group : mapGroupOutputs) {
+        for (const auto& output : group.second) {
+            if (!func(output.second, mapEntries.at(output.second)))
+                return;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2020 The Ion Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef TOKEN_LEDGER_H
+#define TOKEN_LEDGER_H
+
+#include "primitives/transaction.h"
+#include "script/standard.h"
+#include "tokens/groups.h"
+
+#include <functional>
+#include <map>
+#include <set>
+
+/** A grouped wallet output, parsed once when its transaction is added to the wallet */
+class CTokenLedgerEntry
+{
+public:
+    CTokenGroupInfo tokenGroupInfo;
+    // Destination of the output, CNoDestination if it could not be extracted
+    CTxDestination dest;
+
+    CTokenLedgerEntry(const CTokenGroupInfo& tokenGroupInfoIn, const CTxDestination& destIn)
+        : tokenGroupInfo(tokenGroupInfoIn), dest(destIn) {}
+};
+
+/**
+ * Grouped outputs of a wallet, bucketed by token group with the largest token amounts first. Queries only
+ * visit the outputs of the groups they are interested in, and never parse a script again. Entries stay
+ * until their transaction is removed from the wallet; whether an output is still available is decided by
+ * the wallet when the ledger is queried.
+ */
+class CTokenLedger
+{
+private:
+    typedef std::set<std::pair<CAmount, COutPoint>, std::greater<std::pair<CAmount, COutPoint> > > GroupOutputs;
+
+    std::map<COutPoint, CTokenLedgerEntry> mapEntries;
+    std::map<CTokenGroupID, GroupOutputs> mapGroupOutputs;
+
+public:
+    /** Add an output if it is grouped, does nothing if it is already known */
+    void Add(const COutPoint& outpoint, const CScript& scriptPubKey);
+    /** Remove the outputs of a transaction */
+    void EraseTx(const uint256& hash, unsigned int nOutputs);
+    void Clear();
+
+    /** Visit the outputs of one group, largest token amount first, until func returns false */
+    void ForEachGroupOutput(const CTokenGroupID& grpID, std::function<bool(const COutPoint&, const CTokenLedgerEntry&)> func) const;
+    /** Visit the outputs of all groups until func returns false */
+    void ForEachOutput(std::function<bool(const COutPoint&, const CTokenLedgerEntry&)> func) const;
+
+    size_t Size() const { return mapEntries.size(); }
+};
+
+#endif
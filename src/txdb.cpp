@@ -16,7 +16,9 @@
 #include "init.h"
 #include "xion/accumulators.h"
 
+#include <set>
 #include <stdint.h>
+#include <thread>
 
 #include <boost/thread.hpp>
 
@@ -26,9 +28,11 @@ static const char DB_BLOCK_FILES = 'f';
 static const char DB_TXINDEX = 't';
 static const char DB_ADDRESSINDEX = 'a';
 static const char DB_ADDRESSUNSPENTINDEX = 'u';
+static const char DB_ADDRESSSUMMARYINDEX = 'A';
 static const char DB_TIMESTAMPINDEX = 's';
 static const char DB_SPENTINDEX = 'p';
 static const char DB_BLOCK_INDEX = 'b';
+static const char DB_PROOF_OF_STAKE = 'P';
 
 static const char DB_BEST_BLOCK = 'B';
 static const char DB_HEAD_BLOCKS = 'H';
@@ -36,6 +40,8 @@ static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
 
+static const int MAX_BLOCK_INDEX_LOAD_THREADS = 8;
+
 namespace {
 
 struct CoinEntry {
@@ -257,6 +263,14 @@ bool CBlockTreeDB::WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos>
     return WriteBatch(batch);
 }
 
+bool CBlockTreeDB::WriteProofOfStake(const uint256& hashBlock, const uint256& hashProofOfStake) {
+    return Write(std::make_pair(DB_PROOF_OF_STAKE, hashBlock), hashProofOfStake);
+}
+
+bool CBlockTreeDB::ReadProofOfStake(const uint256& hashBlock, uint256& hashProofOfStake) {
+    return Read(std::make_pair(DB_PROOF_OF_STAKE, hashBlock), hashProofOfStake);
+}
+
 bool CBlockTreeDB::ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value) {
     return Read(std::make_pair(DB_SPENTINDEX, key), value);
 }
@@ -315,6 +329,8 @@ bool CBlockTreeDB::WriteAddressIndex(const std::vector<std::pair<CAddressIndexKe
     CDBBatch batch(*this);
     for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
         batch.Write(std::make_pair(DB_ADDRESSINDEX, it->first), it->second);
+    if (!UpdateAddressSummaries(batch, vect, false))
+        return false;
     return WriteBatch(batch);
 }
 
@@ -322,9 +338,203 @@ bool CBlockTreeDB::EraseAddressIndex(const std::vector<std::pair<CAddressIndexKe
     CDBBatch batch(*this);
     for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
         batch.Erase(std::make_pair(DB_ADDRESSINDEX, it->first));
+    // Summaries are read before the batch is written, so the erased entries are still visible
+    if (!UpdateAddressSummaries(batch, vect, true))
+        return false;
     return WriteBatch(batch);
 }
 
+bool CBlockTreeDB::UpdateAddressSummaries(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect, bool fUndo) {
+    struct SummaryDelta {
+        CAmount balance = 0;
+        CAmount received = 0;
+        std::set<uint256> txids;
+        int height = 0;
+    };
+    std::map<std::pair<unsigned int, uint160>, SummaryDelta> mapDeltas;
+
+    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
+        // The entries themselves are overwritten, so the summaries must only change with entries that
+        // are actually added or removed. -reindex-chainstate and a replay after a crash connect blocks
+        // which are already indexed.
+        if (Exists(std::make_pair(DB_ADDRESSINDEX, it->first)) != fUndo)
+            continue;
+        SummaryDelta& delta = mapDeltas[std::make_pair(it->first.type, it->first.hashBytes)];
+        delta.balance += it->second;
+        if (it->second > 0)
+            delta.received += it->second;
+        delta.txids.insert(it->first.txhash);
+        delta.height = std::max(delta.height, it->first.blockHeight);
+    }
+
+    for (const auto& p : mapDeltas) {
+        const auto summaryKey = std::make_pair(DB_ADDRESSSUMMARYINDEX, CAddressIndexIteratorKey(p.first.first, p.first.second));
+        const SummaryDelta& delta = p.second;
+
+        CAddressSummaryValue summary;
+        if (Exists(summaryKey) && !Read(summaryKey, summary))
+            return error("failed to read address summary");
+
+        if (!fUndo) {
+            summary.balance += delta.balance;
+            summary.received += delta.received;
+            summary.txCount += delta.txids.size();
+            summary.lastHeight = std::max(summary.lastHeight, delta.height);
+        } else {
+            summary.balance -= delta.balance;
+            summary.received -= delta.received;
+            summary.txCount -= std::min<int64_t>(summary.txCount, delta.txids.size());
+            if (summary.lastHeight >= delta.height)
+                summary.lastHeight = ReadLastAddressIndexHeight(p.first.second, p.first.first, delta.height);
+        }
+
+        if (summary.IsNull()) {
+            batch.Erase(summaryKey);
+        } else {
+            batch.Write(summaryKey, summary);
+        }
+    }
+    return true;
+}
+
+int CBlockTreeDB::ReadLastAddressIndexHeight(uint160 addressHash, int type, int nHeight) {
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    // the entry before the first one at nHeight is the last one below it
+    pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, addressHash, nHeight)));
+    if (pcursor->Valid()) {
+        pcursor->Prev();
+    } else {
+        pcursor->SeekToLast();
+    }
+
+    std::pair<char,CAddressIndexKey> key;
+    if (pcursor->Valid() && pcursor->GetKey(key) && key.first == DB_ADDRESSINDEX &&
+        key.second.type == (unsigned int)type && key.second.hashBytes == addressHash && key.second.blockHeight < nHeight) {
+        return key.second.blockHeight;
+    }
+    return 0;
+}
+
+bool CBlockTreeDB::ReadAddressSummary(uint160 addressHash, int type, CAddressSummaryValue &summary) {
+    const auto summaryKey = std::make_pair(DB_ADDRESSSUMMARYINDEX, CAddressIndexIteratorKey(type, addressHash));
+    if (!Exists(summaryKey)) {
+        // no activity
+        summary.SetNull();
+        return true;
+    }
+    return Read(summaryKey, summary);
+}
+
+bool CBlockTreeDB::BuildAddressSummaryIndex() {
+    LogPrintf("Building address summary index...\n");
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(DB_ADDRESSINDEX);
+
+    CDBBatch batch(*this);
+    std::pair<unsigned int, uint160> curAddress;
+    CAddressSummaryValue summary;
+    uint256 lastTxHash;
+    size_t nAddresses = 0;
+
+    auto writeSummary = [&]() {
+        if (!summary.IsNull()) {
+            batch.Write(std::make_pair(DB_ADDRESSSUMMARYINDEX, CAddressIndexIteratorKey(curAddress.first, curAddress.second)), summary);
+            nAddresses++;
+        }
+        summary.SetNull();
+    };
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char,CAddressIndexKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSINDEX) {
+            break;
+        }
+        CAmount nValue;
+        if (!pcursor->GetValue(nValue)) {
+            return error("failed to get address index value");
+        }
+
+        // entries are sorted by address and then by height, entries of one transaction are adjacent
+        auto address = std::make_pair(key.second.type, key.second.hashBytes);
+        if (address != curAddress) {
+            writeSummary();
+            curAddress = address;
+            lastTxHash.SetNull();
+        }
+        summary.balance += nValue;
+        if (nValue > 0)
+            summary.received += nValue;
+        if (key.second.txhash != lastTxHash || summary.txCount == 0) {
+            summary.txCount++;
+            lastTxHash = key.second.txhash;
+        }
+        summary.lastHeight = key.second.blockHeight;
+
+        if (batch.SizeEstimate() > (16 << 20)) {
+            if (!WriteBatch(batch))
+                return false;
+            batch.Clear();
+        }
+        pcursor->Next();
+    }
+    writeSummary();
+
+    batch.Write(std::make_pair(DB_FLAG, std::string("addresssummaryindex")), '1');
+    if (!WriteBatch(batch))
+        return false;
+
+    LogPrintf("Built address summary index for %u addresses\n", nAddresses);
+    return true;
+}
+
+bool CBlockTreeDB::ReadAddressIndexPage(const CAddressIndexKey &startKey, int end, size_t &nLimit,
+                                        std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                                        CAddressIndexKey &nextKey, bool &fMore) {
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, startKey));
+
+    fMore = false;
+    bool fFirst = true;
+    uint256 lastTxHash;
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char,CAddressIndexKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_ADDRESSINDEX && key.second.type == startKey.type && key.second.hashBytes == startKey.hashBytes) {
+            if (end > 0 && key.second.blockHeight > end) {
+                break;
+            }
+            // pages never end within a transaction
+            if (fFirst || key.second.txhash != lastTxHash) {
+                if (nLimit == 0) {
+                    nextKey = key.second;
+                    fMore = true;
+                    break;
+                }
+                nLimit--;
+                fFirst = false;
+                lastTxHash = key.second.txhash;
+            }
+            CAmount nValue;
+            if (pcursor->GetValue(nValue)) {
+                addressIndex.push_back(std::make_pair(key.second, nValue));
+                pcursor->Next();
+            } else {
+                return error("failed to get address index value");
+            }
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
 bool CBlockTreeDB::ReadAddressIndex(uint160 addressHash, int type,
                                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
                                     int start, int end) {
@@ -397,70 +607,121 @@ bool CBlockTreeDB::ReadFlag(const std::string &name, bool &fValue) {
     return true;
 }
 
-bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex)
+bool CBlockTreeDB::ReadBlockIndexRange(const Consensus::Params& consensusParams, int nFirstByte, int nEndByte,
+                                       std::vector<CDiskBlockIndex>& vDiskIndexes, std::string& strError)
 {
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
 
-    pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, uint256()));
+    // block hashes are serialized starting with their first byte, which splits the keys into ranges
+    uint256 startHash;
+    *startHash.begin() = (unsigned char)nFirstByte;
+    pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, startHash));
 
-    // Load mapBlockIndex
-    uint256 nPreviousCheckpoint;
     while (pcursor->Valid()) {
-        boost::this_thread::interruption_point();
         std::pair<char, uint256> key;
-        if (pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX) {
-            CDiskBlockIndex diskindex;
-            if (pcursor->GetValue(diskindex)) {
-                // Construct block index object
-                CBlockIndex* pindexNew = insertBlockIndex(diskindex.GetBlockHash());
-                pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
-                pindexNew->nHeight        = diskindex.nHeight;
-                pindexNew->nFile          = diskindex.nFile;
-                pindexNew->nDataPos       = diskindex.nDataPos;
-                pindexNew->nUndoPos       = diskindex.nUndoPos;
-                pindexNew->nVersion       = diskindex.nVersion;
-                pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
-                pindexNew->nTime          = diskindex.nTime;
-                pindexNew->nBits          = diskindex.nBits;
-                pindexNew->nNonce         = diskindex.nNonce;
-                pindexNew->nStatus        = diskindex.nStatus;
-                pindexNew->nTx            = diskindex.nTx;
-
-                // POS
-                pindexNew->nFlags         = diskindex.nFlags;
-                if (pindexNew->nHeight < Params().GetConsensus().nBlockStakeModifierV2) {
-                    pindexNew->nStakeModifier = diskindex.nStakeModifier;
-                } else {
-                    pindexNew->nStakeModifierV2 = diskindex.nStakeModifierV2;
-                }
-                // Zerocoin
-                pindexNew->nAccumulatorCheckpoint = diskindex.nAccumulatorCheckpoint;
-                pindexNew->mapZerocoinSupply = diskindex.mapZerocoinSupply;
-                pindexNew->vMintDenominationsInBlock = diskindex.vMintDenominationsInBlock;
-                // ATP
-                pindexNew->nXDMSupply = diskindex.nXDMSupply;
-                pindexNew->nXDMTransactions = diskindex.nXDMTransactions;
-
-                if (pindexNew->nHeight < consensusParams.POSStartHeight && pindexNew->IsProofOfWork() && !CheckProofOfWork(pindexNew->GetBlockHash(), pindexNew->nBits, consensusParams))
-                    return error("%s: CheckProofOfWork failed: %s", __func__, pindexNew->ToString());
-
-                //populate accumulator checksum map in memory
-                if(pindexNew->nAccumulatorCheckpoint != uint256() && pindexNew->nAccumulatorCheckpoint != nPreviousCheckpoint) {
-                    //Don't load any checkpoints that exist before v2 xion. The accumulator is invalid for v1 and not used.
-                    if (pindexNew->nHeight >= Params().GetConsensus().nBlockZerocoinV2)
-                        LoadAccumulatorValuesFromDB(pindexNew->nAccumulatorCheckpoint);
-
-                    nPreviousCheckpoint = pindexNew->nAccumulatorCheckpoint;
-                }
-                pcursor->Next();
+        if (!pcursor->GetKey(key) || key.first != DB_BLOCK_INDEX || *key.second.begin() >= nEndByte) {
+            break;
+        }
+        vDiskIndexes.emplace_back();
+        CDiskBlockIndex& diskindex = vDiskIndexes.back();
+        if (!pcursor->GetValue(diskindex)) {
+            strError = "failed to read value";
+            return false;
+        }
+        if (diskindex.nHeight < consensusParams.POSStartHeight && diskindex.IsProofOfWork() && !CheckProofOfWork(diskindex.GetBlockHash(), diskindex.nBits, consensusParams)) {
+            strError = strprintf("CheckProofOfWork failed: %s", diskindex.ToString());
+            return false;
+        }
+        pcursor->Next();
+    }
+    return true;
+}
+
+bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex,
+                                      std::function<void(size_t)> reserveBlockIndex)
+{
+    int64_t nTimeStart = GetTimeMicros();
+
+    // Decode the entries in parallel, each thread reads its own range of keys
+    int nThreads = std::max(1, std::min(GetNumCores(), MAX_BLOCK_INDEX_LOAD_THREADS));
+    std::vector<std::vector<CDiskBlockIndex>> vRanges(nThreads);
+    std::vector<std::string> vErrors(nThreads);
+    std::vector<char> vResults(nThreads, 0);
+    std::vector<std::thread> vThreads;
+    for (int i = 0; i < nThreads; i++) {
+        int nFirstByte = i * 256 / nThreads;
+        int nEndByte = (i + 1) * 256 / nThreads;
+        vThreads.emplace_back([&, i, nFirstByte, nEndByte]() {
+            RenameThread("ion-loadblkidx");
+            vResults[i] = ReadBlockIndexRange(consensusParams, nFirstByte, nEndByte, vRanges[i], vErrors[i]);
+        });
+    }
+    for (auto& thread : vThreads) {
+        thread.join();
+    }
+    boost::this_thread::interruption_point();
+
+    size_t nCount = 0;
+    for (int i = 0; i < nThreads; i++) {
+        if (!vResults[i]) {
+            return error("%s: %s", __func__, vErrors[i]);
+        }
+        nCount += vRanges[i].size();
+    }
+
+    int64_t nTimeDecoded = GetTimeMicros();
+    LogPrint(BCLog::BENCHMARK, "    - Decode %u block index entries with %d threads: %.2fms\n", nCount, nThreads, 0.001 * (nTimeDecoded - nTimeStart));
+
+    // Construct the block index objects, all of them are allocated at once
+    reserveBlockIndex(nCount);
+    std::set<uint256> setAccumulatorCheckpoints;
+    for (auto& vDiskIndexes : vRanges) {
+        for (CDiskBlockIndex& diskindex : vDiskIndexes) {
+            CBlockIndex* pindexNew = insertBlockIndex(diskindex.GetBlockHash());
+            pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
+            pindexNew->nHeight        = diskindex.nHeight;
+            pindexNew->nFile          = diskindex.nFile;
+            pindexNew->nDataPos       = diskindex.nDataPos;
+            pindexNew->nUndoPos       = diskindex.nUndoPos;
+            pindexNew->nVersion       = diskindex.nVersion;
+            pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
+            pindexNew->nTime          = diskindex.nTime;
+            pindexNew->nBits          = diskindex.nBits;
+            pindexNew->nNonce         = diskindex.nNonce;
+            pindexNew->nStatus        = diskindex.nStatus;
+            pindexNew->nTx            = diskindex.nTx;
+
+            // POS
+            pindexNew->nFlags         = diskindex.nFlags;
+            if (pindexNew->nHeight < consensusParams.nBlockStakeModifierV2) {
+                pindexNew->nStakeModifier = diskindex.nStakeModifier;
             } else {
-                return error("%s: failed to read value", __func__);
+                pindexNew->nStakeModifierV2 = diskindex.nStakeModifierV2;
+            }
+            // Zerocoin
+            pindexNew->nAccumulatorCheckpoint = diskindex.nAccumulatorCheckpoint;
+            pindexNew->mapZerocoinSupply = std::move(diskindex.mapZerocoinSupply);
+            pindexNew->vMintDenominationsInBlock = std::move(diskindex.vMintDenominationsInBlock);
+            // ATP
+            pindexNew->nXDMSupply = diskindex.nXDMSupply;
+            pindexNew->nXDMTransactions = diskindex.nXDMTransactions;
+
+            //Don't load any checkpoints that exist before v2 xion. The accumulator is invalid for v1 and not used.
+            if (pindexNew->nAccumulatorCheckpoint != uint256() && pindexNew->nHeight >= consensusParams.nBlockZerocoinV2) {
+                setAccumulatorCheckpoints.insert(pindexNew->nAccumulatorCheckpoint);
             }
-        } else {
-            break;
         }
+        // release the decoded entries of a range as soon as they were copied
+        std::vector<CDiskBlockIndex>().swap(vDiskIndexes);
     }
 
+    //populate accumulator checksum map in memory
+    for (const uint256& nCheckpoint : setAccumulatorCheckpoints) {
+        LoadAccumulatorValuesFromDB(nCheckpoint);
+    }
+
+    LogPrint(BCLog::BENCHMARK, "    - Construct block index: %.2fms\n", 0.001 * (GetTimeMicros() - nTimeDecoded));
+
     return true;
 }
 
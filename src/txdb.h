@@ -125,6 +125,8 @@ public:
     bool HasTxIndex(const uint256 &txid);
     bool ReadTxIndex(const uint256 &txid, CDiskTxPos &pos);
     bool WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> > &list);
+    bool WriteProofOfStake(const uint256& hashBlock, const uint256& hashProofOfStake);
+    bool ReadProofOfStake(const uint256& hashBlock, uint256& hashProofOfStake);
     bool ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
     bool UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect);
     bool UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect);
@@ -135,11 +137,37 @@ public:
     bool ReadAddressIndex(uint160 addressHash, int type,
                           std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
                           int start = 0, int end = 0);
+    /**
+     * Reads the entries of the address of startKey, starting at startKey and up to height end (if > 0).
+     * nLimit is the number of transactions which may still be read and is reduced by the number read.
+     * When entries are left, fMore is set and nextKey is the key to continue with.
+     */
+    bool ReadAddressIndexPage(const CAddressIndexKey &startKey, int end, size_t &nLimit,
+                              std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                              CAddressIndexKey &nextKey, bool &fMore);
+    bool ReadAddressSummary(uint160 addressHash, int type, CAddressSummaryValue &summary);
+    /** Builds the address summaries from the address index, for address indexes created before summaries existed */
+    bool BuildAddressSummaryIndex();
     bool WriteTimestampIndex(const CTimestampIndexKey &timestampIndex);
     bool ReadTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &vect);
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
-    bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex);
+private:
+    /** Applies (or undoes) the entries of one block that are not yet (or still) indexed to the summaries of their addresses */
+    bool UpdateAddressSummaries(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect, bool fUndo);
+    /** Height of the last entry of the address below nHeight, or 0 if there is none */
+    int ReadLastAddressIndexHeight(uint160 addressHash, int type, int nHeight);
+    /** Decodes the block index entries whose hash starts with a byte in [nFirstByte, nEndByte) */
+    bool ReadBlockIndexRange(const Consensus::Params& consensusParams, int nFirstByte, int nEndByte,
+                             std::vector<CDiskBlockIndex>& vDiskIndexes, std::string& strError);
+
+public:
+    /**
+     * Loads all block index entries. reserveBlockIndex is called with the number of entries before
+     * insertBlockIndex is called for them, so that they can be allocated at once.
+     */
+    bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex,
+                            std::function<void(size_t)> reserveBlockIndex);
 };
 
 #endif // BITCOIN_TXDB_H
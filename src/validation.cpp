@@ -32,6 +32,7 @@
 #include "primitives/block.h"
 #include "primitives/transaction.h"
 #include "reverse_iterator.h"
+#include "saltedhasher.h"
 #include "script/script.h"
 #include "script/sigcache.h"
 #include "script/standard.h"
@@ -41,6 +42,7 @@
 #include "txmempool.h"
 #include "ui_interface.h"
 #include "undo.h"
+#include "unordered_lru_cache.h"
 #include "util.h"
 #include "spork.h"
 #include "utilmoneystr.h"
@@ -99,6 +101,7 @@ bool fTxIndex = true;
 bool fAddressIndex = false;
 bool fTimestampIndex = false;
 bool fSpentIndex = false;
+bool fTokenIndex = false;
 bool fHavePruned = false;
 bool fPruneMode = false;
 bool fIsBareMultisigStd = DEFAULT_PERMIT_BAREMULTISIG;
@@ -129,8 +132,8 @@ CScript COINBASE_FLAGS;
 
 const std::string strMessageMagic = "Ion Signed Message:\n";
 
-/** Proof of Stake */
-std::map<uint256, uint256> mapProofOfStake;
+/** Proof of Stake hashes of recently connected or looked up blocks, backed by the block tree DB */
+static unordered_lru_cache<uint256, uint256, StaticSaltedHasher> proofOfStakeCache(MAX_PROOF_OF_STAKE_CACHE_SIZE);
 
 // Internal stuff
 namespace {
@@ -898,6 +901,30 @@ bool GetAddressIndex(uint160 addressHash, int type,
     return true;
 }
 
+bool GetAddressIndexPage(const CAddressIndexKey &startKey, int end, size_t &nLimit,
+                         std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                         CAddressIndexKey &nextKey, bool &fMore)
+{
+    if (!fAddressIndex)
+        return error("address index not enabled");
+
+    if (!pblocktree->ReadAddressIndexPage(startKey, end, nLimit, addressIndex, nextKey, fMore))
+        return error("unable to get txids for address");
+
+    return true;
+}
+
+bool GetAddressSummary(uint160 addressHash, int type, CAddressSummaryValue &summary)
+{
+    if (!fAddressIndex)
+        return error("address index not enabled");
+
+    if (!pblocktree->ReadAddressSummary(addressHash, type, summary))
+        return error("unable to get summary for address");
+
+    return true;
+}
+
 bool GetAddressUnspent(uint160 addressHash, int type,
                        std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs)
 {
@@ -969,6 +996,21 @@ bool GetTransaction(const uint256 &hash, CTransactionRef &txOut, const Consensus
     return false;
 }
 
+bool GetProofOfStakeHash(const uint256& hashBlock, uint256& hashProofOfStake)
+{
+    AssertLockHeld(cs_main);
+    if (proofOfStakeCache.get(hashBlock, hashProofOfStake))
+        return true;
+
+    if (!pblocktree->ReadProofOfStake(hashBlock, hashProofOfStake)) {
+        hashProofOfStake.SetNull();
+        return false;
+    }
+
+    proofOfStakeCache.insert(hashBlock, hashProofOfStake);
+    return true;
+}
+
 
 
 
@@ -1000,7 +1042,7 @@ static bool WriteBlockToDisk(const CBlock& block, CDiskBlockPos& pos, const CMes
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams)
+static bool DeserializeBlockFromDisk(CBlock& block, const CDiskBlockPos& pos)
 {
     block.SetNull();
 
@@ -1017,6 +1059,14 @@ bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus:
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
     }
 
+    return true;
+}
+
+bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams)
+{
+    if (!DeserializeBlockFromDisk(block, pos))
+        return false;
+
     // Check the header
     if (block.IsProofOfWork() && !CheckProofOfWork(block.GetHash(), block.nBits, consensusParams))
         return error("ReadBlockFromDisk: Errors in block header at %s", pos.ToString());
@@ -1026,11 +1076,17 @@ bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus:
 
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
 {
-    if (!ReadBlockFromDisk(block, pindex->GetBlockPos(), consensusParams))
+    CDiskBlockPos pos = pindex->GetBlockPos();
+    if (!DeserializeBlockFromDisk(block, pos))
         return false;
-    if (block.GetHash() != pindex->GetBlockHash())
+
+    // Check the header, hashing it only once for both checks
+    uint256 hash = block.GetHash();
+    if (block.IsProofOfWork() && !CheckProofOfWork(hash, block.nBits, consensusParams))
+        return error("ReadBlockFromDisk: Errors in block header at %s", pos.ToString());
+    if (hash != pindex->GetBlockHash())
         return error("ReadBlockFromDisk(CBlock&, CBlockIndex*): GetHash() doesn't match index for %s at %s",
-                pindex->ToString(), pindex->GetBlockPos().ToString());
+                pindex->ToString(), pos.ToString());
     return true;
 }
 
@@ -1361,15 +1417,18 @@ bool CheckInputs(const CTransaction& tx, CValidationState &state, const CCoinsVi
 
             //Check that all token transactions paid their XDM fees
             CAmount nXDMFees = 0;
-            if (IsAnyOutputGrouped(tx)) {
+            // CheckTokenGroups rejected invalid outputs and counted every grouped one
+            bool fAnyOutputGrouped = std::any_of(tgMintMeltBalance.begin(), tgMintMeltBalance.end(),
+                    [](const std::pair<const CTokenGroupID, CTokenGroupBalance>& bal) { return bal.second.numOutputs > 0; });
+            if (fAnyOutputGrouped) {
                 if (!tokenGroupManager->CheckXDMFees(tx, tgMintMeltBalance, state, pindexPrev, nXDMFees)) {
                     return state.DoS(0, error("Token transaction does not pay enough XDM fees"), REJECT_MALFORMED, "token-group-imbalance");
                 }
                 if (!tokenGroupManager->ManagementTokensCreated(chainActive.Height())){
-                    for (const CTxOut &txout : tx.vout)
+                    for (unsigned int i = 0; i < tx.vout.size(); i++)
                     {
-                        CTokenGroupInfo grp(txout.scriptPubKey);
-                        if ((grp.invalid || grp.associatedGroup != NoGroup) && !grp.associatedGroup.hasFlag(TokenGroupIdFlags::MGT_TOKEN)) {
+                        const CTokenGroupInfoRef grp = tokenGroupInfoCache.Get(COutPoint(tx.GetHash(), i), tx.vout[i].scriptPubKey);
+                        if ((grp->invalid || grp->associatedGroup != NoGroup) && !grp->associatedGroup.hasFlag(TokenGroupIdFlags::MGT_TOKEN)) {
                             return state.DoS(0, false, REJECT_NONSTANDARD, "op_group-before-mgt-tokens");
                         }
                     }
@@ -1611,6 +1670,7 @@ static DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex*
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
     std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
+    std::vector<std::pair<CTokenIndexKey, CTokenIndexValue> > tokenIndex;
 
     if (!UndoSpecialTxsInBlock(block, pindex)) {
         return DISCONNECT_FAILED;
@@ -1658,6 +1718,18 @@ static DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex*
 
         }
 
+        if (fTokenIndex) {
+            for (unsigned int k = tx.vout.size(); k-- > 0;) {
+                CTokenIndexKey tokenKey;
+                CTokenIndexValue tokenValue;
+                if (GetTokenIndexEntry(tx.vout[k], hash, k, pindex->nHeight, tokenKey, tokenValue)) {
+                    // undo receiving of tokens
+                    tokenValue.SetSpent();
+                    tokenIndex.push_back(std::make_pair(tokenKey, tokenValue));
+                }
+            }
+        }
+
         // Check that all outputs are available and match the outputs in the block itself
         // exactly.
         for (size_t o = 0; o < tx.vout.size(); o++) {
@@ -1692,6 +1764,16 @@ static DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex*
                     spentIndex.push_back(std::make_pair(CSpentIndexKey(input.prevout.hash, input.prevout.n), CSpentIndexValue()));
                 }
 
+                if (fTokenIndex) {
+                    // restore the spent token output
+                    const Coin &coin = view.AccessCoin(input.prevout);
+                    CTokenIndexKey tokenKey;
+                    CTokenIndexValue tokenValue;
+                    if (GetTokenIndexEntry(coin.out, input.prevout.hash, input.prevout.n, undoHeight, tokenKey, tokenValue)) {
+                        tokenIndex.push_back(std::make_pair(tokenKey, tokenValue));
+                    }
+                }
+
                 if (fAddressIndex) {
                     const Coin &coin = view.AccessCoin(tx.vin[j].prevout);
                     const CTxOut &prevout = coin.out;
@@ -1716,8 +1798,12 @@ static DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex*
 
                     } else if (prevout.scriptPubKey.IsPayToPublicKey()) {
                         uint160 hashBytes(Hash160(prevout.scriptPubKey.begin()+1, prevout.scriptPubKey.end()-1));
-                        addressIndex.push_back(std::make_pair(CAddressIndexKey(1, hashBytes, pindex->nHeight, i, hash, j, false), prevout.nValue));
-                        addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(1, hashBytes, hash, j), CAddressUnspentValue()));
+
+                        // undo spending activity, same key as written by ConnectBlock
+                        addressIndex.push_back(std::make_pair(CAddressIndexKey(1, hashBytes, pindex->nHeight, i, hash, j, true), prevout.nValue * -1));
+
+                        // restore unspent index
+                        addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(1, hashBytes, input.prevout.hash, input.prevout.n), CAddressUnspentValue(prevout.nValue, prevout.scriptPubKey, undoHeight)));
                     } else {
                         continue;
                     }
@@ -1759,6 +1845,13 @@ static DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex*
         }
     }
 
+    if (fTokenIndex) {
+        if (!pTokenDB->UpdateTokenIndex(tokenIndex)) {
+            AbortNode("Failed to write token index");
+            return DISCONNECT_FAILED;
+        }
+    }
+
     evoDb->WriteBestBlock(pindex->pprev->GetBlockHash());
 
     return fClean ? DISCONNECT_OK : DISCONNECT_UNCLEAN;
@@ -1921,8 +2014,9 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     AssertLockHeld(cs_main);
     assert(pindex);
     // pindex->phashBlock can be null if called by CreateNewBlock/TestBlockValidity
+    const uint256 hashBlock = block.GetHash();
     assert((pindex->phashBlock == nullptr) ||
-           (*pindex->phashBlock == block.GetHash()));
+           (*pindex->phashBlock == hashBlock));
     int64_t nTimeStart = GetTimeMicros();
 
     // Check it again in case a previous version let a bad block in
@@ -1949,7 +2043,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
 
     // Special case for the genesis block, skipping connection of its transactions
     // (its coinbase is unspendable)
-    if (block.GetHash() == chainparams.GetConsensus().hashGenesisBlock) {
+    if (hashBlock == chainparams.GetConsensus().hashGenesisBlock) {
         if (!fJustCheck)
             view.SetBestBlock(pindex->GetBlockHash());
         return true;
@@ -2026,7 +2120,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     // make sure old budget is the real one
     if (pindex->nHeight == chainparams.GetConsensus().nSuperblockStartBlock &&
         chainparams.GetConsensus().nSuperblockStartHash != uint256() &&
-        block.GetHash() != chainparams.GetConsensus().nSuperblockStartHash)
+        hashBlock != chainparams.GetConsensus().nSuperblockStartHash)
             return state.DoS(100, error("ConnectBlock(): invalid superblock start"),
                              REJECT_INVALID, "bad-sb-start");
 
@@ -2044,16 +2138,11 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     if (!SetPOSParemeters(block, state, pindex)) {
         return state.Error("Error setting POS parameters");
     }
+    uint256 hashProofOfStake;
     if (block.IsProofOfStake()) {
-        uint256 hashProofOfStake;
-
         if (!CheckProofOfStake(block, hashProofOfStake, pindex)) {
             return state.DoS(100, error("%s: proof of stake check failed", __func__));
         }
-
-        uint256 hash = block.GetHash();
-        if(!mapProofOfStake.count(hash)) // add to mapProofOfStake
-            mapProofOfStake.insert(std::make_pair(hash, hashProofOfStake));
     }
 
     int64_t nTime2 = GetTimeMicros(); nTimeForks += nTime2 - nTime1;
@@ -2074,6 +2163,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
     std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
+    std::vector<std::pair<CTokenIndexKey, CTokenIndexValue> > tokenIndex;
     std::vector<uint256> vSpendsInBlock;
     CAmount nValueIn = 0;
     //! Zerocoin
@@ -2169,6 +2259,19 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
                 }
 
             }
+            if (fTokenIndex) {
+                for (size_t j = 0; j < tx->vin.size(); j++) {
+                    const COutPoint &prevout = tx->vin[j].prevout;
+                    const Coin& coin = view.AccessCoin(prevout);
+                    CTokenIndexKey tokenKey;
+                    CTokenIndexValue tokenValue;
+                    if (GetTokenIndexEntry(coin.out, prevout.hash, prevout.n, coin.nHeight, tokenKey, tokenValue)) {
+                        // remove spent token output
+                        tokenValue.SetSpent();
+                        tokenIndex.push_back(std::make_pair(tokenKey, tokenValue));
+                    }
+                }
+            }
             if (IsAnyOutputGroupedCreation(*tx)) {
                 if (pindex->nHeight < chainparams.GetConsensus().ATPStartHeight) {
                     return state.DoS(0, false, REJECT_NONSTANDARD, "premature-op_group-tx");
@@ -2185,7 +2288,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
                 }
 */
                 CTokenGroupCreation newTokenGroupCreation;
-                if (CreateTokenGroup(tx, block.GetHash(), newTokenGroupCreation)) {
+                if (CreateTokenGroup(tx, hashBlock, newTokenGroupCreation)) {
                     newTokenGroups.push_back(newTokenGroupCreation);
                 } else {
                     return state.Invalid(false, REJECT_INVALID, "bad OP_GROUP");
@@ -2263,6 +2366,17 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
             }
         }
 
+        if (fTokenIndex) {
+            for (unsigned int k = 0; k < tx->vout.size(); k++) {
+                CTokenIndexKey tokenKey;
+                CTokenIndexValue tokenValue;
+                if (GetTokenIndexEntry(tx->vout[k], txhash, k, pindex->nHeight, tokenKey, tokenValue)) {
+                    // record unspent token output
+                    tokenIndex.push_back(std::make_pair(tokenKey, tokenValue));
+                }
+            }
+        }
+
         CTxUndo undoDummy;
         if (i > 0) {
             blockundo.vtxundo.push_back(CTxUndo());
@@ -2359,7 +2473,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     //Track xION money supply in the block index
     if (!UpdateXIONSupply(block, pindex, fJustCheck))
         return state.DoS(100, error("%s: Failed to calculate new xION supply for block=%s height=%d", __func__,
-                                    block.GetHash().GetHex(), pindex->nHeight), REJECT_INVALID);
+                                    hashBlock.GetHex(), pindex->nHeight), REJECT_INVALID);
 
     // Track XDM money supply in the block index
     pindex->nXDMTransactions = tokenGroupManager->GetXDMInBlock(block);
@@ -2370,10 +2484,10 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     if (!ValidateAccumulatorCheckpoint(block, pindex, mapAccumulators)) {
         if (!ShutdownRequested()) {
             return state.DoS(100, error("%s: Failed to validate accumulator checkpoint for block=%s height=%d", __func__,
-                                   block.GetHash().GetHex(), pindex->nHeight), REJECT_INVALID, "bad-acc-checkpoint");
+                                   hashBlock.GetHex(), pindex->nHeight), REJECT_INVALID, "bad-acc-checkpoint");
         }
         return error("%s: Failed to validate accumulator checkpoint for block=%s height=%d because wallet is shutting down", __func__,
-                block.GetHash().GetHex(), pindex->nHeight);
+                hashBlock.GetHex(), pindex->nHeight);
     }
 
     if (fJustCheck)
@@ -2430,6 +2544,11 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     // Flush spend/mint info to disk
     if (!zerocoinDB->WriteCoinSpendBatch(vSpends)) return AbortNode(state, ("Failed to record coin serials to database"));
     if (!zerocoinDB->WriteCoinMintBatch(vMints)) return AbortNode(state, ("Failed to record new mints to database"));
+    if (!pindex->vMintDenominationsInBlock.empty()) {
+        std::list<libzerocoin::PublicCoin> listPubcoins;
+        if (!BlockToPubcoinList(block, listPubcoins, false) || !zerocoinDB->WriteBlockMints(pindex->GetBlockHash(), listPubcoins))
+            return AbortNode(state, ("Failed to record block mint list to database"));
+    }
 
     //Record accumulator checksums
     DatabaseChecksums(mapAccumulators);
@@ -2438,6 +2557,12 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
         if (!pblocktree->WriteTxIndex(vPos))
             return AbortNode(state, "Failed to write transaction index");
 
+    if (block.IsProofOfStake()) {
+        if (!pblocktree->WriteProofOfStake(pindex->GetBlockHash(), hashProofOfStake))
+            return AbortNode(state, "Failed to write proof of stake");
+        proofOfStakeCache.insert(pindex->GetBlockHash(), hashProofOfStake);
+    }
+
     if (fAddressIndex) {
         if (!pblocktree->WriteAddressIndex(addressIndex)) {
             return AbortNode(state, "Failed to write address index");
@@ -2456,6 +2581,10 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
         if (!pblocktree->WriteTimestampIndex(CTimestampIndexKey(pindex->nTime, pindex->GetBlockHash())))
             return AbortNode(state, "Failed to write timestamp index");
 
+    if (fTokenIndex)
+        if (!pTokenDB->UpdateTokenIndex(tokenIndex))
+            return AbortNode(state, "Failed to write token index");
+
     if (!pTokenDB->WriteTokenGroupsBatch(newTokenGroups))
         return AbortNode(state, "Failed to write token creation data");
     if (!tokenGroupManager->AddTokenGroups(newTokenGroups)) {
@@ -3060,6 +3189,8 @@ bool ActivateBestChain(CValidationState &state, const CChainParams& chainparams,
     CBlockIndex *pindexMostWork = nullptr;
     CBlockIndex *pindexNewTip = nullptr;
     int nStopAtHeight = gArgs.GetArg("-stopatheight", DEFAULT_STOPATHEIGHT);
+    // hashed once, the loop might run several times
+    const uint256 hashBlock = pblock ? pblock->GetHash() : uint256();
     do {
         boost::this_thread::interruption_point();
         if (ShutdownRequested())
@@ -3082,7 +3213,7 @@ bool ActivateBestChain(CValidationState &state, const CChainParams& chainparams,
 
             bool fInvalidFound = false;
             std::shared_ptr<const CBlock> nullBlockPtr;
-            if (!ActivateBestChainStep(state, chainparams, pindexMostWork, pblock && pblock->GetHash() == pindexMostWork->GetBlockHash() ? pblock : nullBlockPtr, fInvalidFound, connectTrace))
+            if (!ActivateBestChainStep(state, chainparams, pindexMostWork, pblock && hashBlock == pindexMostWork->GetBlockHash() ? pblock : nullBlockPtr, fInvalidFound, connectTrace))
                 return false;
 
             if (fInvalidFound) {
@@ -3257,10 +3388,9 @@ bool ResetBlockFailureFlags(CBlockIndex *pindex) {
     return true;
 }
 
-static CBlockIndex* AddToBlockIndex(const CBlockHeader& block, enum BlockStatus nStatus = BLOCK_VALID_TREE)
+static CBlockIndex* AddToBlockIndex(const CBlockHeader& block, const uint256& hash, enum BlockStatus nStatus = BLOCK_VALID_TREE)
 {
     // Check for duplicate
-    uint256 hash = block.GetHash();
     BlockMap::iterator it = mapBlockIndex.find(hash);
     if (it != mapBlockIndex.end())
         return it->second;
@@ -3444,16 +3574,16 @@ static bool FindUndoPos(CValidationState &state, int nFile, CDiskBlockPos &pos,
     return true;
 }
 
-static bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true)
+static bool CheckBlockHeader(const CBlockHeader& block, const uint256& hash, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true)
 {
     // Check proof of work matches claimed amount
-    if (fCheckPOW && !CheckProofOfWork(block.GetHash(), block.nBits, consensusParams))
+    if (fCheckPOW && !CheckProofOfWork(hash, block.nBits, consensusParams))
         return state.DoS(50, false, REJECT_INVALID, "high-hash", false, "proof of work failed");
 
     // Check DevNet
     if (!consensusParams.hashDevnetGenesisBlock.IsNull() &&
             block.hashPrevBlock == consensusParams.hashGenesisBlock &&
-            block.GetHash() != consensusParams.hashDevnetGenesisBlock) {
+            hash != consensusParams.hashDevnetGenesisBlock) {
         return state.DoS(100, error("CheckBlockHeader(): wrong devnet genesis"),
                          REJECT_INVALID, "devnet-genesis");
     }
@@ -3461,6 +3591,14 @@ static bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state,
     return true;
 }
 
+static bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true)
+{
+    // Only hash the header when one of the checks needs it
+    if (!fCheckPOW && consensusParams.hashDevnetGenesisBlock.IsNull())
+        return true;
+    return CheckBlockHeader(block, block.GetHash(), state, consensusParams, fCheckPOW);
+}
+
 bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW, bool fCheckMerkleRoot)
 {
     // These are checks that are independent of context.
@@ -3662,7 +3800,7 @@ static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state
             return true;
         }
 
-        if (!CheckBlockHeader(block, state, chainparams.GetConsensus(), fCheckPOW))
+        if (!CheckBlockHeader(block, hash, state, chainparams.GetConsensus(), fCheckPOW))
             return error("%s: Consensus::CheckBlockHeader: %s, %s", __func__, hash.ToString(), FormatStateMessage(state));
 
         // Get prev block index
@@ -3700,13 +3838,13 @@ static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state
 
         if (llmq::chainLocksHandler->HasConflictingChainLock(pindexPrev->nHeight + 1, hash)) {
             if (pindex == nullptr) {
-                AddToBlockIndex(block, BLOCK_CONFLICT_CHAINLOCK);
+                AddToBlockIndex(block, hash, BLOCK_CONFLICT_CHAINLOCK);
             }
             return state.DoS(10, error("%s: header %s conflicts with chainlock", __func__, hash.ToString()), REJECT_INVALID, "bad-chainlock");
         }
     }
     if (pindex == nullptr)
-        pindex = AddToBlockIndex(block);
+        pindex = AddToBlockIndex(block, hash);
 
     if (ppindex)
         *ppindex = pindex;
@@ -4095,6 +4233,39 @@ fs::path GetBlockPosFilename(const CDiskBlockPos &pos, const char *prefix)
     return GetDataDir() / "blocks" / strprintf("%s%05u.dat", prefix, pos.nFile);
 }
 
+/**
+ * Block index entries loaded at startup are allocated in one contiguous block, which is only freed
+ * as a whole. Entries created afterwards are allocated one by one.
+ */
+static std::unique_ptr<CBlockIndex[]> blockIndexArena;
+static size_t nBlockIndexArenaSize = 0;
+static size_t nBlockIndexArenaUsed = 0;
+
+static void ReserveBlockIndex(size_t nCount)
+{
+    mapBlockIndex.reserve(mapBlockIndex.size() + nCount);
+    if (nBlockIndexArenaUsed == 0) {
+        blockIndexArena.reset(new CBlockIndex[nCount]);
+        nBlockIndexArenaSize = nCount;
+    }
+}
+
+static void FreeBlockIndex(CBlockIndex* pindex)
+{
+    std::less<const CBlockIndex*> less;
+    if (blockIndexArena && !less(pindex, blockIndexArena.get()) && less(pindex, blockIndexArena.get() + nBlockIndexArenaSize)) {
+        return;
+    }
+    delete pindex;
+}
+
+static void FreeBlockIndexArena()
+{
+    blockIndexArena.reset();
+    nBlockIndexArenaSize = 0;
+    nBlockIndexArenaUsed = 0;
+}
+
 CBlockIndex * InsertBlockIndex(uint256 hash)
 {
     if (hash.IsNull())
@@ -4106,9 +4277,12 @@ CBlockIndex * InsertBlockIndex(uint256 hash)
         return (*mi).second;
 
     // Create new
-    CBlockIndex* pindexNew = new CBlockIndex();
-    if (!pindexNew)
-        throw std::runtime_error(std::string(__func__) + ": new CBlockIndex failed");
+    CBlockIndex* pindexNew;
+    if (nBlockIndexArenaUsed < nBlockIndexArenaSize) {
+        pindexNew = &blockIndexArena[nBlockIndexArenaUsed++];
+    } else {
+        pindexNew = new CBlockIndex();
+    }
     mi = mapBlockIndex.insert(std::make_pair(hash, pindexNew)).first;
     pindexNew->phashBlock = &((*mi).first);
 
@@ -4117,28 +4291,42 @@ CBlockIndex * InsertBlockIndex(uint256 hash)
 
 bool static LoadBlockIndexDB(const CChainParams& chainparams)
 {
-    if (!pblocktree->LoadBlockIndexGuts(chainparams.GetConsensus(), InsertBlockIndex))
+    int64_t nTimeStart = GetTimeMicros();
+
+    if (!pblocktree->LoadBlockIndexGuts(chainparams.GetConsensus(), InsertBlockIndex, ReserveBlockIndex))
         return false;
 
     boost::this_thread::interruption_point();
 
-    // Calculate nChainWork
-    std::vector<std::pair<int, CBlockIndex*> > vSortedByHeight;
-    vSortedByHeight.reserve(mapBlockIndex.size());
+    int64_t nTimeLoaded = GetTimeMicros();
+
+    // Calculate nChainWork. Parents are always one block lower, so bucketing the entries by height is
+    // enough to visit every parent before its children.
+    int nMaxHeight = 0;
+    for (const std::pair<uint256, CBlockIndex*>& item : mapBlockIndex) {
+        nMaxHeight = std::max(nMaxHeight, item.second->nHeight);
+    }
+    std::vector<size_t> vHeightOffsets(nMaxHeight + 2, 0);
+    for (const std::pair<uint256, CBlockIndex*>& item : mapBlockIndex) {
+        vHeightOffsets[item.second->nHeight + 1]++;
+    }
+    for (int nHeight = 1; nHeight <= nMaxHeight + 1; nHeight++) {
+        vHeightOffsets[nHeight] += vHeightOffsets[nHeight - 1];
+    }
+    std::vector<CBlockIndex*> vSortedByHeight(mapBlockIndex.size());
+    mapPrevBlockIndex.reserve(mapBlockIndex.size());
     for (const std::pair<uint256, CBlockIndex*>& item : mapBlockIndex)
     {
         CBlockIndex* pindex = item.second;
-        vSortedByHeight.push_back(std::make_pair(pindex->nHeight, pindex));
+        vSortedByHeight[vHeightOffsets[pindex->nHeight]++] = pindex;
 
         // build mapPrevBlockIndex
         if (pindex->pprev) {
             mapPrevBlockIndex.emplace(pindex->pprev->GetBlockHash(), pindex);
         }
     }
-    sort(vSortedByHeight.begin(), vSortedByHeight.end());
-    for (const std::pair<int, CBlockIndex*>& item : vSortedByHeight)
+    for (CBlockIndex* pindex : vSortedByHeight)
     {
-        CBlockIndex* pindex = item.second;
         pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) + GetBlockProof(*pindex);
         pindex->nTimeMax = (pindex->pprev ? std::max(pindex->pprev->nTimeMax, pindex->nTime) : pindex->nTime);
         // We can link the chain of blocks for which we've received transactions at some point.
@@ -4172,6 +4360,10 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
             pindexBestHeader = pindex;
     }
 
+    int64_t nTimeChainWork = GetTimeMicros();
+    LogPrint(BCLog::BENCHMARK, "  - Load block index: %.2fms\n", 0.001 * (nTimeLoaded - nTimeStart));
+    LogPrint(BCLog::BENCHMARK, "  - Calculate chain work: %.2fms\n", 0.001 * (nTimeChainWork - nTimeLoaded));
+
     // Load block file info
     pblocktree->ReadLastBlockFile(nLastBlockFile);
     vinfoBlockFile.resize(nLastBlockFile + 1);
@@ -4207,6 +4399,8 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
         }
     }
 
+    LogPrint(BCLog::BENCHMARK, "  - Check block files: %.2fms\n", 0.001 * (GetTimeMicros() - nTimeChainWork));
+
     // Check whether we have ever pruned block & undo files
     pblocktree->ReadFlag("prunedblockfiles", fHavePruned);
     if (fHavePruned)
@@ -4225,6 +4419,15 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
     pblocktree->ReadFlag("addressindex", fAddressIndex);
     LogPrintf("%s: address index %s\n", __func__, fAddressIndex ? "enabled" : "disabled");
 
+    // Address indexes created before address summaries were added need them built once
+    bool fAddressSummaryIndex = false;
+    pblocktree->ReadFlag("addresssummaryindex", fAddressSummaryIndex);
+    if (fAddressIndex && !fAddressSummaryIndex) {
+        uiInterface.InitMessage(_("Building address summary index..."));
+        if (!pblocktree->BuildAddressSummaryIndex())
+            return error("%s: failed to build address summary index", __func__);
+    }
+
     // Check whether we have a timestamp index
     pblocktree->ReadFlag("timestampindex", fTimestampIndex);
     LogPrintf("%s: timestamp index %s\n", __func__, fTimestampIndex ? "enabled" : "disabled");
@@ -4233,6 +4436,10 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
     pblocktree->ReadFlag("spentindex", fSpentIndex);
     LogPrintf("%s: spent index %s\n", __func__, fSpentIndex ? "enabled" : "disabled");
 
+    // Check whether we have a token index
+    pblocktree->ReadFlag("tokenindex", fTokenIndex);
+    LogPrintf("%s: token index %s\n", __func__, fTokenIndex ? "enabled" : "disabled");
+
     return true;
 }
 
@@ -4483,9 +4690,10 @@ void UnloadBlockIndex()
     }
 
     for (BlockMap::value_type& entry : mapBlockIndex) {
-        delete entry.second;
+        FreeBlockIndex(entry.second);
     }
     mapBlockIndex.clear();
+    FreeBlockIndexArena();
     fHavePruned = false;
 }
 
@@ -4514,6 +4722,7 @@ bool LoadBlockIndex(const CChainParams& chainparams)
         // Use the provided setting for -addressindex in the new database
         fAddressIndex = gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
         pblocktree->WriteFlag("addressindex", fAddressIndex);
+        pblocktree->WriteFlag("addresssummaryindex", fAddressIndex);
 
         // Use the provided setting for -timestampindex in the new database
         fTimestampIndex = gArgs.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
@@ -4522,6 +4731,10 @@ bool LoadBlockIndex(const CChainParams& chainparams)
         // Use the provided setting for -spentindex in the new database
         fSpentIndex = gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
         pblocktree->WriteFlag("spentindex", fSpentIndex);
+
+        // Use the provided setting for -tokenindex in the new database
+        fTokenIndex = gArgs.GetBoolArg("-tokenindex", DEFAULT_TOKENINDEX);
+        pblocktree->WriteFlag("tokenindex", fTokenIndex);
     }
     return true;
 }
@@ -4535,7 +4748,7 @@ static bool AddGenesisBlock(const CChainParams& chainparams, const CBlock& block
         return error("%s: FindBlockPos failed", __func__);
     if (!WriteBlockToDisk(block, blockPos, chainparams.MessageStart()))
         return error("%s: writing genesis block to disk failed", __func__);
-    CBlockIndex *pindex = AddToBlockIndex(block);
+    CBlockIndex *pindex = AddToBlockIndex(block, block.GetHash());
     if (!ReceivedBlockTransactions(block, state, pindex, blockPos))
         return error("%s: genesis block not accepted", __func__);
     return true;
@@ -5044,7 +5257,8 @@ public:
         // block headers
         BlockMap::iterator it1 = mapBlockIndex.begin();
         for (; it1 != mapBlockIndex.end(); it1++)
-            delete (*it1).second;
+            FreeBlockIndex((*it1).second);
         mapBlockIndex.clear();
+        FreeBlockIndexArena();
     }
 } instance_of_cmaincleanup;
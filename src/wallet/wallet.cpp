@@ -1168,6 +1168,9 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
         if (!walletdb.WriteTx(wtx))
             return false;
 
+    // Outputs may have become ours since the transaction was first added, e.g. after a key import
+    AddToTokenLedger(wtx);
+
     // Break debit/credit balance caches:
     wtx.MarkDirty();
 
@@ -1189,6 +1192,16 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
     return true;
 }
 
+void CWallet::AddToTokenLedger(const CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+    const uint256& hash = wtx.GetHash();
+    for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+        if (IsMine(wtx.tx->vout[i]) != ISMINE_NO)
+            tokenLedger.Add(COutPoint(hash, i), wtx.tx->vout[i].scriptPubKey);
+    }
+}
+
 bool CWallet::LoadToWallet(const CWalletTx& wtxIn)
 {
     uint256 hash = wtxIn.GetHash();
@@ -2935,6 +2948,26 @@ CAmount CWallet::GetAvailableBalance(const CCoinControl* coinControl) const
     return balance;
 }
 
+bool CWallet::IsFilterCandidate(const CWalletTx* pcoin, int& nDepth) const
+{
+    if (!CheckFinalTx(*pcoin))
+        return false;
+
+    if (pcoin->IsGenerated() && pcoin->GetBlocksToMaturity() > 0)
+        return false;
+
+    nDepth = pcoin->GetDepthInMainChain();
+    if (nDepth < 0)
+        return false;
+
+    // We should not consider coins which aren't at least in our mempool
+    // It's possible for these to be conflicted via ancestors which we may never be able to detect
+    if (nDepth == 0 && !pcoin->InMempool())
+        return false;
+
+    return true;
+}
+
 unsigned int CWallet::FilterCoins(std::vector<COutput> &vCoins,
     std::function<bool(const CWalletTx *, const CTxOut *)> func) const
 {
@@ -2948,19 +2981,8 @@ unsigned int CWallet::FilterCoins(std::vector<COutput> &vCoins,
             const uint256 &wtxid = it->first;
             const CWalletTx *pcoin = &(*it).second;
 
-            if (!CheckFinalTx(*pcoin))
-                continue;
-
-            if (pcoin->IsGenerated() && pcoin->GetBlocksToMaturity() > 0)
-                continue;
-
-            int nDepth = pcoin->GetDepthInMainChain();
-            if (nDepth < 0)
-                continue;
-
-            // We should not consider coins which aren't at least in our mempool
-            // It's possible for these to be conflicted via ancestors which we may never be able to detect
-            if (nDepth == 0 && !pcoin->InMempool())
+            int nDepth;
+            if (!IsFilterCandidate(pcoin, nDepth))
                 continue;
 
             for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++)
@@ -2980,6 +3002,42 @@ unsigned int CWallet::FilterCoins(std::vector<COutput> &vCoins,
     return ret;
 }
 
+unsigned int CWallet::FilterGroupedCoins(std::vector<COutput> &vCoins, const CTokenGroupID* pgrpID,
+    std::function<bool(const CWalletTx *, const CTxOut *, const CTokenLedgerEntry &)> func) const
+{
+    vCoins.clear();
+    unsigned int ret = 0;
+
+    LOCK2(cs_main, cs_wallet);
+    auto visit = [&](const COutPoint& outpoint, const CTokenLedgerEntry& entry) {
+        auto it = mapWallet.find(outpoint.hash);
+        if (it == mapWallet.end())
+            return true;
+
+        const CWalletTx *pcoin = &it->second;
+        int nDepth;
+        if (!IsFilterCandidate(pcoin, nDepth))
+            return true;
+
+        const CTxOut *out = &pcoin->tx->vout[outpoint.n];
+        isminetype mine = IsMine(*out);
+        if (!IsSpent(outpoint.hash, outpoint.n) && mine != ISMINE_NO && !IsLockedCoin(outpoint.hash, outpoint.n) &&
+            func(pcoin, out, entry))
+        {
+            vCoins.emplace_back(pcoin, outpoint.n, nDepth, (mine & ISMINE_SPENDABLE) != ISMINE_NO, false, false);
+            ret++;
+        }
+        return true;
+    };
+
+    if (pgrpID)
+        tokenLedger.ForEachGroupOutput(*pgrpID, visit);
+    else
+        tokenLedger.ForEachOutput(visit);
+
+    return ret;
+}
+
 void CWallet::AvailableCoins(std::vector<COutput> &vCoins, bool fOnlySafe, const CCoinControl *coinControl, const CAmount &nMinimumAmount, const CAmount &nMaximumAmount, const CAmount &nMinimumSumAmount, const uint64_t &nMaximumCount, const int &nMinDepth, const int &nMaxDepth, const bool includeGrouped) const
 {
     vCoins.clear();
@@ -4515,6 +4573,8 @@ DBErrors CWallet::LoadWallet(bool& fFirstRunRet)
                     setWalletUTXO.insert(COutPoint(pair.first, i));
                 }
             }
+            // Done once all keys are loaded, watch-only scripts are read after the transactions
+            AddToTokenLedger(pair.second);
         }
     }
 
@@ -4550,8 +4610,13 @@ DBErrors CWallet::ZapSelectTx(std::vector<uint256>& vHashIn, std::vector<uint256
     AssertLockHeld(cs_wallet); // mapWallet
     vchDefaultKey = CPubKey();
     DBErrors nZapSelectTxRet = CWalletDB(*dbw,"cr+").ZapSelectTx(vHashIn, vHashOut);
-    for (uint256 hash : vHashOut)
-        mapWallet.erase(hash);
+    for (uint256 hash : vHashOut) {
+        auto it = mapWallet.find(hash);
+        if (it != mapWallet.end()) {
+            tokenLedger.EraseTx(hash, it->second.tx->vout.size());
+            mapWallet.erase(it);
+        }
+    }
 
     if (nZapSelectTxRet == DB_NEED_REWRITE)
     {
@@ -20,6 +20,7 @@
 #include "utilstrencodings.h"
 #include "validationinterface.h"
 #include "script/ismine.h"
+#include "tokens/tokenledger.h"
 #include "wallet/coincontrol.h"
 #include "wallet/crypter.h"
 #include "wallet/walletdb.h"
@@ -790,6 +791,13 @@ private:
 
     std::set<COutPoint> setWalletUTXO;
 
+    // Grouped outputs of mapWallet, guarded by cs_wallet
+    CTokenLedger tokenLedger;
+    void AddToTokenLedger(const CWalletTx& wtx);
+
+    /* Transaction level checks of FilterCoins, sets the depth of a transaction that passes them */
+    bool IsFilterCandidate(const CWalletTx* pcoin, int& nDepth) const;
+
     /* Mark a transaction (and its in-wallet descendants) as conflicting with a particular block. */
     void MarkConflicted(const uint256& hashBlock, const uint256& hashTx);
 
@@ -949,6 +957,13 @@ public:
     unsigned int FilterCoins(std::vector<COutput> &vCoins,
         std::function<bool(const CWalletTx *, const CTxOut *)>) const;
 
+    /**
+     * FilterCoins over the grouped outputs in the token ledger, passing their already parsed group info.
+     * When pgrpID is set only that group is visited, with the largest token amounts first.
+     */
+    unsigned int FilterGroupedCoins(std::vector<COutput> &vCoins, const CTokenGroupID* pgrpID,
+        std::function<bool(const CWalletTx *, const CTxOut *, const CTokenLedgerEntry &)>) const;
+
     /**
      * Return list of available coins and locked coins grouped by non-change output address.
      */
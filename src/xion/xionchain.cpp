@@ -5,6 +5,8 @@
 #include "xion/xionchain.h"
 
 #include "consensus/validation.h"
+#include "ctpl.h"
+#include "init.h"
 #include "pos/checks.h"
 #include "xion/xionmodule.h"
 #include "xion/zerocoindb.h"
@@ -71,6 +73,76 @@ bool BlockToPubcoinList(const CBlock& block, std::list<libzerocoin::PublicCoin>&
     return true;
 }
 
+static bool IndexBlockMints(const CBlockIndex* pindex, std::list<libzerocoin::PublicCoin>& listPubcoins)
+{
+    CBlock block;
+    if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus()))
+        return error("%s: failed to read block %s from disk", __func__, pindex->GetBlockHash().GetHex());
+
+    if (!BlockToPubcoinList(block, listPubcoins, false))
+        return error("%s: failed to get zerocoin mintlist from block %d", __func__, pindex->nHeight);
+
+    if (!zerocoinDB->WriteBlockMints(pindex->GetBlockHash(), listPubcoins))
+        return error("%s: failed to write mint list of block %d", __func__, pindex->nHeight);
+
+    return true;
+}
+
+bool GetBlockPubcoins(const CBlockIndex* pindex, std::list<libzerocoin::PublicCoin>& listPubcoins)
+{
+    // Connected blocks record their minted denominations, blocks without mints have nothing to read
+    if (pindex->vMintDenominationsInBlock.empty())
+        return true;
+
+    if (zerocoinDB->ReadBlockMints(pindex->GetBlockHash(), listPubcoins))
+        return true;
+
+    listPubcoins.clear();
+    return IndexBlockMints(pindex, listPubcoins);
+}
+
+bool ReindexBlockMints(int nThreads)
+{
+    std::vector<const CBlockIndex*> vMissing;
+    {
+        LOCK(cs_main);
+        for (const CBlockIndex* pindex = chainActive.Genesis(); pindex; pindex = chainActive.Next(pindex)) {
+            if (!pindex->vMintDenominationsInBlock.empty() && !zerocoinDB->HaveBlockMints(pindex->GetBlockHash()))
+                vMissing.push_back(pindex);
+        }
+    }
+    if (vMissing.empty())
+        return true;
+
+    LogPrintf("%s: indexing mints of %u blocks using %d threads\n", __func__, (unsigned int)vMissing.size(), nThreads);
+    int64_t nTimeStart = GetTimeMillis();
+
+    ctpl::thread_pool pool(std::max(1, nThreads));
+    RenameThreadPool(pool, "ion-mintidx");
+
+    // Each job reads and indexes every nJobs-th block, block files are only read here
+    const int nJobs = pool.size();
+    std::atomic<bool> fFailed(false);
+    std::vector<std::future<void> > futures;
+    for (int nJob = 0; nJob < nJobs; nJob++) {
+        futures.emplace_back(pool.push([&, nJob](int threadId) {
+            for (size_t i = nJob; i < vMissing.size() && !fFailed && !ShutdownRequested(); i += nJobs) {
+                std::list<libzerocoin::PublicCoin> listPubcoins;
+                if (!IndexBlockMints(vMissing[i], listPubcoins))
+                    fFailed = true;
+            }
+        }));
+    }
+    for (auto& f : futures)
+        f.get();
+
+    if (fFailed)
+        return error("%s: failed to index block mints", __func__);
+
+    LogPrintf("%s: indexed mints of %u blocks in %dms\n", __func__, (unsigned int)vMissing.size(), GetTimeMillis() - nTimeStart);
+    return true;
+}
+
 //return a list of zerocoin mints contained in a specific block
 bool BlockToZerocoinMintList(const CBlock& block, std::list<CZerocoinMint>& vMints, bool fFilterInvalid)
 {
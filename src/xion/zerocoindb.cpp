@@ -144,3 +144,29 @@ bool CZerocoinDB::EraseAccumulatorValue(const uint32_t& nChecksum)
     LogPrint(BCLog::ZEROCOIN, "%s : checksum:%d\n", __func__, nChecksum);
     return Erase(std::make_pair('2', nChecksum));
 }
+
+bool CZerocoinDB::WriteBlockMints(const uint256& hashBlock, const std::list<libzerocoin::PublicCoin>& listPubcoins)
+{
+    BlockMintList vMints;
+    vMints.reserve(listPubcoins.size());
+    for (const libzerocoin::PublicCoin& pubcoin : listPubcoins)
+        vMints.emplace_back(pubcoin.getDenomination(), pubcoin.getValue());
+
+    return Write(std::make_pair('b', hashBlock), vMints);
+}
+
+bool CZerocoinDB::ReadBlockMints(const uint256& hashBlock, std::list<libzerocoin::PublicCoin>& listPubcoins)
+{
+    BlockMintList vMints;
+    if (!Read(std::make_pair('b', hashBlock), vMints))
+        return false;
+
+    for (const auto& mint : vMints)
+        listPubcoins.emplace_back(Params().Zerocoin_Params(false), mint.second, mint.first);
+    return true;
+}
+
+bool CZerocoinDB::HaveBlockMints(const uint256& hashBlock)
+{
+    return Exists(std::make_pair('b', hashBlock));
+}
@@ -11,6 +11,9 @@
 #include "libzerocoin/Coin.h"
 #include "libzerocoin/CoinSpend.h"
 
+/** Pubcoins minted in a block as (denomination, value), in block order */
+typedef std::vector<std::pair<libzerocoin::CoinDenomination, CBigNum> > BlockMintList;
+
 /** Zerocoin database (zerocoin/) */
 class CZerocoinDB : public CDBWrapper
 {
@@ -36,6 +39,10 @@ public:
     bool WriteAccumulatorValue(const uint32_t& nChecksum, const CBigNum& bnValue);
     bool ReadAccumulatorValue(const uint32_t& nChecksum, CBigNum& bnValue);
     bool EraseAccumulatorValue(const uint32_t& nChecksum);
+    /** Index of the pubcoins minted in each block, so accumulators can be computed without reading block files */
+    bool WriteBlockMints(const uint256& hashBlock, const std::list<libzerocoin::PublicCoin>& listPubcoins);
+    bool ReadBlockMints(const uint256& hashBlock, std::list<libzerocoin::PublicCoin>& listPubcoins);
+    bool HaveBlockMints(const uint256& hashBlock);
 };
 
 #endif //ION_ZEROCOINDB_H
@@ -11,7 +11,7 @@ CZMQAbstractNotifier::~CZMQAbstractNotifier()
     assert(!psocket);
 }
 
-bool CZMQAbstractNotifier::NotifyBlock(const CBlockIndex * /*CBlockIndex*/)
+bool CZMQAbstractNotifier::NotifyBlock(const CBlockIndex * /*CBlockIndex*/, const CZMQPayload& /*payload*/)
 {
     return true;
 }
@@ -21,7 +21,7 @@ bool CZMQAbstractNotifier::NotifyChainLock(const CBlockIndex * /*CBlockIndex*/,
     return true;
 }
 
-bool CZMQAbstractNotifier::NotifyTransaction(const CTransaction &/*transaction*/)
+bool CZMQAbstractNotifier::NotifyTransaction(const CTransaction &/*transaction*/, const CZMQPayload& /*payload*/)
 {
     return true;
 }
@@ -7,6 +7,9 @@
 
 #include "zmqconfig.h"
 
+#include <memory>
+#include <vector>
+
 class CBlockIndex;
 class CGovernanceObject;
 class CGovernanceVote;
@@ -19,6 +22,24 @@ namespace llmq {
 
 typedef CZMQAbstractNotifier* (*CZMQNotifierFactory)();
 
+/**
+ * A serialized object, or a part of one, published without being copied. All raw notifiers of the
+ * same event reference the same buffer, which is released once the last message using it is sent.
+ */
+struct CZMQPayload
+{
+    std::shared_ptr<const std::vector<unsigned char> > buffer;
+    size_t nOffset{0};
+    size_t nSize{0};
+
+    CZMQPayload() {}
+    CZMQPayload(const std::shared_ptr<const std::vector<unsigned char> >& bufferIn, size_t nOffsetIn, size_t nSizeIn) :
+        buffer(bufferIn), nOffset(nOffsetIn), nSize(nSizeIn) {}
+
+    bool IsNull() const { return !buffer; }
+    const unsigned char* data() const { return buffer->data() + nOffset; }
+};
+
 class CZMQAbstractNotifier
 {
 public:
@@ -39,9 +60,11 @@ public:
     virtual bool Initialize(void *pcontext) = 0;
     virtual void Shutdown() = 0;
 
-    virtual bool NotifyBlock(const CBlockIndex *pindex);
+    // payload is the serialized block if it was still in memory, null otherwise
+    virtual bool NotifyBlock(const CBlockIndex *pindex, const CZMQPayload& payload);
     virtual bool NotifyChainLock(const CBlockIndex *pindex, const llmq::CChainLockSig& clsig);
-    virtual bool NotifyTransaction(const CTransaction &transaction);
+    // payload is the serialized transaction, null if no raw notifier is configured
+    virtual bool NotifyTransaction(const CTransaction &transaction, const CZMQPayload& payload);
     virtual bool NotifyTransactionLock(const CTransaction &transaction, const llmq::CInstantSendLock& islock);
     virtual bool NotifyGovernanceVote(const CGovernanceVote &vote);
     virtual bool NotifyGovernanceObject(const CGovernanceObject &object);
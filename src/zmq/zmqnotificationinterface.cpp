@@ -15,7 +15,39 @@ void zmqError(const char *str)
     LogPrint(BCLog::ZMQ, "zmq: Error: %s, errno=%s\n", str, zmq_strerror(errno));
 }
 
-CZMQNotificationInterface::CZMQNotificationInterface() : pcontext(nullptr)
+// Serialize the block once, the raw block is the whole buffer and each raw transaction a part of it
+static CZMQPayload SerializeBlock(const CBlock &block, std::vector<CZMQPayload> &vTxPayloads)
+{
+    auto buffer = std::make_shared<std::vector<unsigned char> >();
+    std::vector<std::pair<size_t, size_t> > vTxPos;
+    vTxPos.reserve(block.vtx.size());
+
+    CVectorWriter writer(SER_NETWORK, PROTOCOL_VERSION, *buffer, 0);
+    writer << static_cast<const CBlockHeader&>(block);
+    WriteCompactSize(writer, block.vtx.size());
+    for (const CTransactionRef& ptx : block.vtx) {
+        size_t nPos = buffer->size();
+        writer << *ptx;
+        vTxPos.emplace_back(nPos, buffer->size() - nPos);
+    }
+    if (block.vtx.size() > 1 && block.vtx[1]->IsCoinStake())
+        writer << block.vchBlockSig;
+
+    std::shared_ptr<const std::vector<unsigned char> > data = buffer;
+    vTxPayloads.clear();
+    for (const auto& pos : vTxPos)
+        vTxPayloads.emplace_back(data, pos.first, pos.second);
+    return CZMQPayload(data, 0, data->size());
+}
+
+static CZMQPayload SerializeTransaction(const CTransaction &tx)
+{
+    auto buffer = std::make_shared<std::vector<unsigned char> >();
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION, *buffer, 0, tx);
+    return CZMQPayload(buffer, 0, buffer->size());
+}
+
+CZMQNotificationInterface::CZMQNotificationInterface() : pcontext(nullptr), fPublishRaw(false)
 {
 }
 
@@ -70,6 +102,7 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     {
         notificationInterface = new CZMQNotificationInterface();
         notificationInterface->notifiers = notifiers;
+        notificationInterface->fPublishRaw = gArgs.IsArgSet("-zmqpubrawblock") || gArgs.IsArgSet("-zmqpubrawtx");
 
         if (!notificationInterface->Initialize())
         {
@@ -115,6 +148,8 @@ bool CZMQNotificationInterface::Initialize()
         return false;
     }
 
+    CZMQAbstractPublishNotifier::StartSendThread();
+
     return true;
 }
 
@@ -124,6 +159,7 @@ void CZMQNotificationInterface::Shutdown()
     LogPrint(BCLog::ZMQ, "zmq: Shutdown notification interface\n");
     if (pcontext)
     {
+        CZMQAbstractPublishNotifier::StopSendThread();
         for (std::list<CZMQAbstractNotifier*>::iterator i=notifiers.begin(); i!=notifiers.end(); ++i)
         {
             CZMQAbstractNotifier *notifier = *i;
@@ -138,13 +174,20 @@ void CZMQNotificationInterface::Shutdown()
 
 void CZMQNotificationInterface::UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload)
 {
+    // The block is only kept until the tip is published
+    CZMQPayload payload;
+    if (hashLastConnected == pindexNew->GetBlockHash())
+        payload = lastConnectedPayload;
+    hashLastConnected.SetNull();
+    lastConnectedPayload = CZMQPayload();
+
     if (fInitialDownload || pindexNew == pindexFork) // In IBD or blocks were disconnected without any new ones
         return;
 
     for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
     {
         CZMQAbstractNotifier *notifier = *i;
-        if (notifier->NotifyBlock(pindexNew))
+        if (notifier->NotifyBlock(pindexNew, payload))
         {
             i++;
         }
@@ -173,16 +216,12 @@ void CZMQNotificationInterface::NotifyChainLock(const CBlockIndex *pindex, const
     }
 }
 
-void CZMQNotificationInterface::TransactionAddedToMempool(const CTransactionRef& ptx, int64_t nAcceptTime)
+void CZMQNotificationInterface::PublishTransaction(const CTransaction &tx, const CZMQPayload& payload)
 {
-    // Used by BlockConnected and BlockDisconnected as well, because they're
-    // all the same external callback.
-    const CTransaction& tx = *ptx;
-
     for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
     {
         CZMQAbstractNotifier *notifier = *i;
-        if (notifier->NotifyTransaction(tx))
+        if (notifier->NotifyTransaction(tx, payload))
         {
             i++;
         }
@@ -194,19 +233,42 @@ void CZMQNotificationInterface::TransactionAddedToMempool(const CTransactionRef&
     }
 }
 
+void CZMQNotificationInterface::TransactionAddedToMempool(const CTransactionRef& ptx, int64_t nAcceptTime)
+{
+    const CTransaction& tx = *ptx;
+    PublishTransaction(tx, fPublishRaw ? SerializeTransaction(tx) : CZMQPayload());
+}
+
 void CZMQNotificationInterface::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexConnected, const std::vector<CTransactionRef>& vtxConflicted)
 {
-    for (const CTransactionRef& ptx : pblock->vtx) {
+    // Blocks aren't published during initial download (see UpdatedBlockTip), so they aren't serialized either.
+    // Raw transaction notifiers serialize the transactions themselves then.
+    if (!fPublishRaw || IsInitialBlockDownload()) {
+        for (const CTransactionRef& ptx : pblock->vtx) {
+            // Do a normal notify for each transaction added in the block
+            PublishTransaction(*ptx, CZMQPayload());
+        }
+        return;
+    }
+
+    std::vector<CZMQPayload> vTxPayloads;
+    lastConnectedPayload = SerializeBlock(*pblock, vTxPayloads);
+    hashLastConnected = pindexConnected->GetBlockHash();
+    for (size_t i = 0; i < pblock->vtx.size(); i++) {
         // Do a normal notify for each transaction added in the block
-        TransactionAddedToMempool(ptx, 0);
+        PublishTransaction(*pblock->vtx[i], vTxPayloads[i]);
     }
 }
 
 void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexDisconnected)
 {
-    for (const CTransactionRef& ptx : pblock->vtx) {
+    std::vector<CZMQPayload> vTxPayloads;
+    if (fPublishRaw)
+        SerializeBlock(*pblock, vTxPayloads);
+
+    for (size_t i = 0; i < pblock->vtx.size(); i++) {
         // Do a normal notify for each transaction removed in block disconnection
-        TransactionAddedToMempool(ptx, 0);
+        PublishTransaction(*pblock->vtx[i], fPublishRaw ? vTxPayloads[i] : CZMQPayload());
     }
 }
 
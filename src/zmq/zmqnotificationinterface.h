@@ -6,12 +6,12 @@
 #define BITCOIN_ZMQ_ZMQNOTIFICATIONINTERFACE_H
 
 #include "validationinterface.h"
+#include "zmqabstractnotifier.h"
 #include <string>
 #include <map>
 #include <list>
 
 class CBlockIndex;
-class CZMQAbstractNotifier;
 
 class CZMQNotificationInterface : public CValidationInterface
 {
@@ -39,8 +39,16 @@ protected:
 private:
     CZMQNotificationInterface();
 
+    void PublishTransaction(const CTransaction &tx, const CZMQPayload& payload);
+
     void *pcontext;
     std::list<CZMQAbstractNotifier*> notifiers;
+
+    // Serialize blocks and transactions once for all raw notifiers, only if any are configured
+    bool fPublishRaw;
+    // Last connected block, published by UpdatedBlockTip without reading it back from disk
+    uint256 hashLastConnected;
+    CZMQPayload lastConnectedPayload;
 };
 
 #endif // BITCOIN_ZMQ_ZMQNOTIFICATIONINTERFACE_H
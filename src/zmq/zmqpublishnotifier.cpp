@@ -9,6 +9,11 @@
 #include "validation.h"
 #include "util.h"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
 
 static const char *MSG_HASHBLOCK     = "hashblock";
@@ -28,47 +33,102 @@ static const char *MSG_RAWGVOTE      = "rawgovernancevote";
 static const char *MSG_RAWGOBJ       = "rawgovernanceobject";
 static const char *MSG_RAWISCON      = "rawinstantsenddoublespend";
 
-// Internal function to send multipart message
-static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
+/** A message waiting for the send thread */
+struct CZMQQueuedMessage
+{
+    void *psocket;
+    const char *command;
+    CZMQPayload payload;
+    uint32_t nSequence;
+};
+
+static std::mutex csSendQueue;
+static std::condition_variable condSendQueue;
+static std::deque<CZMQQueuedMessage> sendQueue;
+static bool fStopSendThread = false;
+static std::thread sendThread;
+
+// Called by zmq once the data part has been sent, releases our reference to the buffer
+static void zmq_free_payload(void * /*data*/, void *hint)
 {
-    va_list args;
-    va_start(args, size);
+    delete static_cast<std::shared_ptr<const std::vector<unsigned char> >*>(hint);
+}
 
-    while (1)
+// Internal function to send multipart message, the data part references the payload instead of copying it
+static int zmq_send_queued_message(const CZMQQueuedMessage &message)
+{
+    if (zmq_send(message.psocket, message.command, strlen(message.command), ZMQ_SNDMORE) == -1)
     {
-        zmq_msg_t msg;
+        zmqError("Unable to send ZMQ msg");
+        return -1;
+    }
 
-        int rc = zmq_msg_init_size(&msg, size);
-        if (rc != 0)
-        {
-            zmqError("Unable to initialize ZMQ msg");
-            va_end(args);
-            return -1;
-        }
+    zmq_msg_t msg;
+    auto hint = new std::shared_ptr<const std::vector<unsigned char> >(message.payload.buffer);
+    int rc = zmq_msg_init_data(&msg, (void*)message.payload.data(), message.payload.nSize, zmq_free_payload, hint);
+    if (rc != 0)
+    {
+        zmqError("Unable to initialize ZMQ msg");
+        delete hint;
+        return -1;
+    }
 
-        void *buf = zmq_msg_data(&msg);
-        memcpy(buf, data, size);
+    rc = zmq_msg_send(&msg, message.psocket, ZMQ_SNDMORE);
+    if (rc == -1)
+    {
+        zmqError("Unable to send ZMQ msg");
+        zmq_msg_close(&msg);
+        return -1;
+    }
+    zmq_msg_close(&msg);
+
+    unsigned char msgseq[sizeof(uint32_t)];
+    WriteLE32(&msgseq[0], message.nSequence);
+    if (zmq_send(message.psocket, msgseq, sizeof(msgseq), 0) == -1)
+    {
+        zmqError("Unable to send ZMQ msg");
+        return -1;
+    }
 
-        data = va_arg(args, const void*);
+    return 0;
+}
 
-        rc = zmq_msg_send(&msg, sock, data ? ZMQ_SNDMORE : 0);
-        if (rc == -1)
+static void ThreadSendMessages()
+{
+    while (true)
+    {
+        std::deque<CZMQQueuedMessage> messages;
         {
-            zmqError("Unable to send ZMQ msg");
-            zmq_msg_close(&msg);
-            va_end(args);
-            return -1;
+            std::unique_lock<std::mutex> lock(csSendQueue);
+            condSendQueue.wait(lock, [] { return fStopSendThread || !sendQueue.empty(); });
+            if (sendQueue.empty())
+                return;
+            messages.swap(sendQueue);
         }
 
-        zmq_msg_close(&msg);
+        for (const CZMQQueuedMessage &message : messages)
+            zmq_send_queued_message(message);
+    }
+}
 
-        if (!data)
-            break;
+void CZMQAbstractPublishNotifier::StartSendThread()
+{
+    assert(!sendThread.joinable());
+    fStopSendThread = false;
+    sendThread = std::thread(&TraceThread<std::function<void()> >, "zmqsend", std::function<void()>(ThreadSendMessages));
+}
 
-        size = va_arg(args, size_t);
+void CZMQAbstractPublishNotifier::StopSendThread()
+{
+    if (!sendThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(csSendQueue);
+        fStopSendThread = true;
     }
-    va_end(args);
-    return 0;
+    condSendQueue.notify_one();
+    sendThread.join();
 }
 
 bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
@@ -131,33 +191,50 @@ void CZMQAbstractPublishNotifier::Shutdown()
 
     if (count == 1)
     {
+        // queued messages may still reference the socket, let the send thread finish them first
+        bool fRestartSendThread = sendThread.joinable();
+        StopSendThread();
+
         LogPrint(BCLog::ZMQ, "Close socket at address %s\n", address);
         int linger = 0;
         zmq_setsockopt(psocket, ZMQ_LINGER, &linger, sizeof(linger));
         zmq_close(psocket);
+
+        if (fRestartSendThread)
+            StartSendThread();
     }
 
     psocket = 0;
 }
 
 bool CZMQAbstractPublishNotifier::SendMessage(const char *command, const void* data, size_t size)
+{
+    const unsigned char *pdata = static_cast<const unsigned char*>(data);
+    auto buffer = std::make_shared<const std::vector<unsigned char> >(pdata, pdata + size);
+    return SendMessage(command, CZMQPayload(buffer, 0, size));
+}
+
+bool CZMQAbstractPublishNotifier::SendMessage(const char *command, const CZMQPayload& payload)
 {
     assert(psocket);
+    assert(!payload.IsNull());
 
-    /* send three parts, command & data & a LE 4byte sequence number */
-    unsigned char msgseq[sizeof(uint32_t)];
-    WriteLE32(&msgseq[0], nSequence);
-    int rc = zmq_send_multipart(psocket, command, strlen(command), data, size, msgseq, (size_t)sizeof(uint32_t), (void*)0);
-    if (rc == -1)
-        return false;
+    {
+        std::lock_guard<std::mutex> lock(csSendQueue);
+        if (sendQueue.size() < MAX_ZMQ_SEND_QUEUE_SIZE)
+            sendQueue.push_back(CZMQQueuedMessage{psocket, command, payload, nSequence});
+        else
+            LogPrint(BCLog::ZMQ, "zmq: Send queue full, dropping %s message %u\n", command, nSequence);
+    }
+    condSendQueue.notify_one();
 
-    /* increment memory only sequence number after sending */
+    /* increment memory only sequence number, also for dropped messages so subscribers can detect the gap */
     nSequence++;
 
     return true;
 }
 
-bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
+bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex, const CZMQPayload& payload)
 {
     uint256 hash = pindex->GetBlockHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish hashblock %s\n", hash.GetHex());
@@ -177,7 +254,7 @@ bool CZMQPublishHashChainLockNotifier::NotifyChainLock(const CBlockIndex *pindex
     return SendMessage(MSG_HASHCHAINLOCK, data, 32);
 }
 
-bool CZMQPublishHashTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
+bool CZMQPublishHashTransactionNotifier::NotifyTransaction(const CTransaction &transaction, const CZMQPayload& payload)
 {
     uint256 hash = transaction.GetHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish hashtx %s\n", hash.GetHex());
@@ -231,10 +308,13 @@ bool CZMQPublishHashInstantSendDoubleSpendNotifier::NotifyInstantSendDoubleSpend
 }
 
 
-bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
+bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex, const CZMQPayload& payload)
 {
     LogPrint(BCLog::ZMQ, "zmq: Publish rawblock %s\n", pindex->GetBlockHash().GetHex());
 
+    if (!payload.IsNull())
+        return SendMessage(MSG_RAWBLOCK, payload);
+
     const Consensus::Params& consensusParams = Params().GetConsensus();
     CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
     {
@@ -295,10 +375,13 @@ bool CZMQPublishRawChainLockSigNotifier::NotifyChainLock(const CBlockIndex *pind
     return SendMessage(MSG_RAWCLSIG, &(*ss.begin()), ss.size());
 }
 
-bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
+bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction, const CZMQPayload& payload)
 {
     uint256 hash = transaction.GetHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish rawtx %s\n", hash.GetHex());
+    if (!payload.IsNull())
+        return SendMessage(MSG_RAWTX, payload);
+
     CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
     ss << transaction;
     return SendMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
@@ -11,29 +11,38 @@ class CBlockIndex;
 class CGovernanceVote;
 class CGovernanceObject;
 
+/** Maximum number of messages waiting for the send thread, new messages are dropped while it is full */
+static const size_t MAX_ZMQ_SEND_QUEUE_SIZE = 10000;
+
 class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier
 {
 private:
-    uint32_t nSequence; //!< upcounting per message sequence number
+    uint32_t nSequence{0}; //!< upcounting per message sequence number
 
 public:
 
-    /* send zmq multipart message
+    /* queue zmq multipart message for the send thread
        parts:
           * command
           * data
           * message sequence number
     */
     bool SendMessage(const char *command, const void* data, size_t size);
+    bool SendMessage(const char *command, const CZMQPayload& payload);
 
     bool Initialize(void *pcontext) override;
     void Shutdown() override;
+
+    /* all sockets are only written by the send thread, so that slow subscribers never stall validation.
+       It must be stopped before the sockets are shut down, queued messages are sent before it exits */
+    static void StartSendThread();
+    static void StopSendThread();
 };
 
 class CZMQPublishHashBlockNotifier : public CZMQAbstractPublishNotifier
 {
 public:
-    bool NotifyBlock(const CBlockIndex *pindex) override;
+    bool NotifyBlock(const CBlockIndex *pindex, const CZMQPayload& payload) override;
 };
 
 class CZMQPublishHashChainLockNotifier : public CZMQAbstractPublishNotifier
@@ -45,7 +54,7 @@ public:
 class CZMQPublishHashTransactionNotifier : public CZMQAbstractPublishNotifier
 {
 public:
-    bool NotifyTransaction(const CTransaction &transaction) override;
+    bool NotifyTransaction(const CTransaction &transaction, const CZMQPayload& payload) override;
 };
 
 class CZMQPublishHashTransactionLockNotifier : public CZMQAbstractPublishNotifier
@@ -75,7 +84,7 @@ public:
 class CZMQPublishRawBlockNotifier : public CZMQAbstractPublishNotifier
 {
 public:
-    bool NotifyBlock(const CBlockIndex *pindex) override;
+    bool NotifyBlock(const CBlockIndex *pindex, const CZMQPayload& payload) override;
 };
 
 class CZMQPublishRawChainLockNotifier : public CZMQAbstractPublishNotifier
@@ -93,7 +102,7 @@ public:
 class CZMQPublishRawTransactionNotifier : public CZMQAbstractPublishNotifier
 {
 public:
-    bool NotifyTransaction(const CTransaction &transaction) override;
+    bool NotifyTransaction(const CTransaction &transaction, const CZMQPayload& payload) override;
 };
 
 class CZMQPublishRawTransactionLockNotifier : public CZMQAbstractPublishNotifier